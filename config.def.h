@@ -4,6 +4,7 @@ int   default_height     = 600;
 float zoom_step          = 10;
 float scroll_step        = 40;
 int   n_completion_items = 15;
+int   tabbar_min_width   = 120;
 
 /* completion */
 static const char FORMAT_COMMAND[]     = "<b>%s</b>";
@@ -16,6 +17,10 @@ static const char JUMANJI_BOOKMARKS[] = "bookmarks";
 static const char JUMANJI_HISTORY[]   = "history";
 static const char JUMANJI_COOKIES[]   = "cookies";
 static const char JUMANJI_SESSIONS[]  = "sessions";
+static const char JUMANJI_CACHE[]     = "cache";
+static const char JUMANJI_ADBLOCK[]   = "adblock";
+static const char JUMANJI_HTTPS[]     = "https";
+static const char JUMANJI_DNS[]       = "dns";
 
 /* browser specific settings */
 char* user_agent           = NULL;
@@ -24,11 +29,23 @@ char* home_page            = "http://pwmt.org";
 char* proxy                = NULL;
 gboolean private_browsing  = FALSE;
 gboolean plugin_blocker    = TRUE;
+gboolean content_blocker   = TRUE;
+gboolean dns_prefetch      = TRUE;
+gboolean prerender         = FALSE;
+int prerender_timeout      = 30;  /* in seconds, an unused prerendered page is discarded */
 gboolean full_content_zoom = FALSE;
 char* default_session_name = NULL;
 int auto_save_interval     = 0;
-int search_delay           = 400; /* in millisecond */
+int search_delay           = 400; /* in millisecond, upper bound of the adaptive delay */
+int search_delay_min       = 20;  /* in millisecond, lower bound of the adaptive delay */
+int search_mark_limit      = 1000;
+int update_interval        = 16;  /* in millisecond */
 int history_limit          = 0;
+int cache_size             = 50;  /* in megabyte, 0 disables the disk cache */
+int cookie_save_interval   = 5;   /* in seconds */
+int background_connections = 2;   /* concurrent requests of a background tab */
+int dns_cache_ttl          = 300; /* in seconds, 0 disables the dns cache */
+char* hint_characters      = "0123456789";
 
 /* download settings */
 char* download_dir     = "~/dl/";
@@ -177,7 +194,9 @@ Command commands[] = {
   {"back",      0,              cmd_back,            0,            "Go back in the browser history" },
   {"bmap",      0,              cmd_bmap,            0,            "Map a buffered command" },
   {"bmark",     "b",            cmd_bookmark,        0,            "Add a bookmark" },
+  {"dnsstats",  0,              cmd_dnsstats,        0,            "Show the hits and misses of the DNS cache" },
   {"forward",   "f",            cmd_forward,         0,            "Go forward in the browser history" },
+  {"loadstats", 0,              cmd_loadstats,       0,            "Show or export the load timeline of the current page" },
   {"map",       "m",            cmd_map,             0,            "Map a key sequence" },
   {"open",      "o",            cmd_open,            cc_open,      "Open URI in the current tab" },
   {"plugin",    0,              cmd_plugintype,      0,            "Allow plugin type" },
@@ -189,10 +208,13 @@ Command commands[] = {
   {"saveas",    0,              cmd_saveas,          0,            "Save current document to disk" },
   {"scheme",    0,              cmd_schemehandler,   0,            "Set URI scheme handler" },
   {"script",    0,              cmd_script,          0,            "Load a javascript file" },
+  {"searchall", 0,              cmd_searchall,       cc_searchall, "Search all open tabs" },
+  {"searchstats",0,             cmd_searchstats,     0,            "Show the measured search timings of the current tab" },
   {"sessionload","sl",          cmd_sessionload,     cc_session,   "Load session with specified name" },
   {"sessionsave","ssa",         cmd_sessionsave,     cc_session,   "Save session with specified name" },
   {"sessionswitch","ssw",       cmd_sessionswitch,   cc_session,   "Close all the current tabs and load session" },
   {"set",       "s",            cmd_set,             cc_set,       "Set an option" },
+  {"setlocal",  "sel",          cmd_setlocal,        cc_set,       "Set an option for the current tab only" },
   {"stop",      "st",           cmd_stop,            0,            "Stop loading the current page" },
   {"tabopen",   "t",            cmd_tabopen,         cc_open,      "Open URI in a new tab" },
   {"winopen",   "w",            cmd_winopen,         cc_open,      "Open URI in a new window" },
@@ -246,6 +268,8 @@ Setting settings[] = {
   {"history_limit",          &(history_limit),          NULL,                           'i',  1, 0, 0, "Limit history length"},
   {"auto_shrink_images",     NULL,                      "auto-shrink-images",           'b',  0, 1, 0, "Shrink standalone images to fit"},
   {"background",             NULL,                      "print-backgrounds",            'b',  0, 1, 0, "Print background images"},
+  {"background_connections", &(background_connections), NULL,                           'i',  0, 0, 0, "Number of concurrent requests of a tab in the background"},
+  {"cache_size",             &(cache_size),             NULL,                           'i',  0, 0, 0, "Size of the disk cache in megabyte"},
   {"caret_browsing",         NULL,                      "enable-caret-browsing",        'b',  0, 1, 0, "Wheter to enable caret browsing mode"},
   {"completion_bgcolor",     &(completion_bgcolor),     NULL,                           's',  1, 0, 0, "Completion background color"},
   {"completion_fgcolor",     &(completion_fgcolor),     NULL,                           's',  1, 0, 0, "Completion foreground color"},
@@ -253,11 +277,15 @@ Setting settings[] = {
   {"completion_g_fgcolor",   &(completion_g_fgcolor),   NULL,                           's',  1, 0, 0, "Completion (group) foreground color"},
   {"completion_hl_bgcolor",  &(completion_hl_bgcolor),  NULL,                           's',  1, 0, 0, "Completion (highlight) background color"},
   {"completion_hl_fgcolor",  &(completion_hl_fgcolor),  NULL,                           's',  1, 0, 0, "Completion (highlight) foreground color"},
+  {"content_blocker",        &(content_blocker),        NULL,                           'b',  0, 0, 0, "Block requests matching the rules in the adblock file"},
+  {"cookie_save_interval",   &(cookie_save_interval),   NULL,                           'i',  0, 0, 0, "Seconds to collect cookie changes before writing the cookie file"},
   {"cursive_font",           NULL,                      "cursive-font-family",          's',  0, 1, 0, "Default cursive font family to display text"},
   {"default_bgcolor",        &(default_bgcolor),        NULL,                           's',  1, 0, 0, "Default background color"},
   {"default_fgcolor",        &(default_fgcolor),        NULL,                           's',  1, 0, 0, "Default foreground color"},
   {"default_session_name",   &(default_session_name),   NULL,                           's',  1, 0, 0, "Set default session name and enable session saving between jumanji runs"},
   {"developer_extras",       NULL,                      "enable-developer-extras",      'b',  0, 1, 0, "Enable webkit developer extensions"},
+  {"dns_cache_ttl",          &(dns_cache_ttl),          NULL,                           'i',  0, 0, 0, "Seconds to keep resolved host names"},
+  {"dns_prefetch",           &(dns_prefetch),           NULL,                           'b',  0, 0, 0, "Resolve the host of hovered and likely followed links in advance"},
   {"download_command",       &(download_command),       NULL,                           's',  0, 0, 0, "Command for downloading files"},
   {"download_dir",           &(download_dir),           NULL,                           's',  0, 0, 0, "The default download directory"},
   {"editor",                 &(spawn_editor),           NULL,                           's',  0, 0, 0, "Command to spawn the default editor"},
@@ -268,6 +296,7 @@ Setting settings[] = {
   {"font_size",              NULL,                      "default-font-size",            'i',  0, 1, 0, "The default font size to display text"},
   {"full_content_zoom",      &(full_content_zoom),      "full-content-zoom",            'b',  0, 0, 1, "Wheter the full content is scaled when zooming"},
   {"height",                 &(default_height),         NULL,                           'i',  1, 0, 0, "Default window height"},
+  {"hint_characters",        &(hint_characters),        NULL,                           's',  0, 0, 0, "Characters used to label link hints"},
   {"homepage",               &(home_page),              NULL,                           's',  0, 0, 0, "Home page"},
   {"images",                 NULL,                      "auto-load-images",             'b',  0, 1, 0, "Load images automatically"},
   {"inputbar_bgcolor",       &(inputbar_bgcolor),       NULL,                           's',  1, 0, 0, "Inputbar background color"},
@@ -285,6 +314,8 @@ Setting settings[] = {
   {"page_cache",             NULL,                      "enable-page-cache",            'b',  0, 1, 0, "Enable page cache"},
   {"plugin_blocker",         &(plugin_blocker),         NULL,                           'b',  0, 1, 0, "Enable plugin-blocker"},
   {"plugins",                NULL,                      "enable-plugins",               'b',  0, 1, 0, "Enable embedded plugin objects"},
+  {"prerender",              &(prerender),              NULL,                           'b',  0, 0, 0, "Load the likely next page in a hidden view"},
+  {"prerender_timeout",      &(prerender_timeout),      NULL,                           'i',  0, 0, 0, "Seconds to keep an unused prerendered page"},
   {"private_browsing",       &(private_browsing),       "enable-private-browsing",      'b',  0, 0, 0, "Enable private browsing"},
   {"proxy",                  &(proxy),                  NULL,                           's',  0, 0, 0, "Set proxy"},
   {"resizable_text_areas",   NULL,                      "resizable-text-areas",         'b',  0, 1, 0, "Resizable text areas"},
@@ -292,6 +323,9 @@ Setting settings[] = {
   {"scripts",                NULL,                      "enable-scripts",               'b',  0, 1, 0, "Enable embedded scripting languages"},
   {"scroll_step",            &(scroll_step),            NULL,                           'f',  1, 0, 0, "Scroll step"},
   {"scrollbars",             &(show_scrollbars),        NULL,                           'b',  0, 0, 0, "Show scrollbars"},
+  {"search_delay",           &(search_delay),           NULL,                           'i',  0, 0, 0, "Maximum delay of an incremental search in millisecond"},
+  {"search_delay_min",       &(search_delay_min),       NULL,                           'i',  0, 0, 0, "Minimum delay of an incremental search in millisecond"},
+  {"search_mark_limit",      &(search_mark_limit),      NULL,                           'i',  0, 0, 0, "Maximum number of highlighted search matches"},
   {"serif_font",             NULL,                      "serif-font-family",            's',  0, 1, 0, "Serif font family"},
   {"spell_checking",         NULL,                      "enable-spell-checking",        'b',  0, 1, 0, "Enable spell checking while typing"},
   {"spell_checking_lang",    NULL,                      "spell-checking-languages",     's',  0, 1, 0, "Spell checking languages"},
@@ -307,6 +341,7 @@ Setting settings[] = {
   {"tabbar_fgcolor",         &(tabbar_fgcolor),         NULL,                           's',  1, 0, 0, "Tabbar foreground color"},
   {"tabbar_focus_bgcolor",   &(tabbar_focus_bgcolor),   NULL,                           's',  1, 0, 0, "Tabbar (focus) background color"},
   {"tabbar_focus_fgcolor",   &(tabbar_focus_fgcolor),   NULL,                           's',  1, 0, 0, "Tabbar (focus) foreground color"},
+  {"tabbar_min_width",       &(tabbar_min_width),       NULL,                           'i',  0, 0, 0, "Minimum width of a tab before the tabbar scrolls"},
   {"tabbar_separator_color", &(tabbar_separator_color), NULL,                           's',  1, 0, 0, "Tabbar separator color"},
   {"user_agent",             &(user_agent),             "user-agent",                   's',  1, 0, 0, "User agent"},
   {"width",                  &(default_width),          NULL,                           'i',  1, 0, 0, "Default window width"},
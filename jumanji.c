@@ -4,12 +4,19 @@
 #define _XOPEN_SOURCE 500
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <math.h>
 #include <regex.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#define LIBSOUP_USE_UNSTABLE_REQUEST_API
 
 #include <libsoup/soup.h>
+#include <libsoup/soup-cache.h>
 #include <unique/unique.h>
 
 #include <gdk/gdkkeysyms.h>
@@ -20,6 +27,17 @@
 
 /* macros */
 #define LENGTH(x) sizeof(x)/sizeof((x)[0])
+#define BLOCK_NODE(n) g_array_index(Jumanji.Blocker.nodes, BlockNode, (n))
+#define BLOCK_RULE(n) g_array_index(Jumanji.Blocker.rules, BlockRule, (n))
+#define DNS_NEGATIVE_TTL 30
+#define DNS_WARM_HOSTS 10
+#define HTTPS_REDIRECT_TTL (30 * 24 * 60 * 60)
+#define LOAD_TIMELINE_SIZE 256
+#define PREFETCH_INTERVAL 100
+#define PREFETCH_TTL 60
+#define REQUEST_TAG_TIMEOUT 10
+#define SEARCH_ALL_MATCHES 5
+#define SEARCH_ALL_CONTEXT 30
 #define ALL_MASK (GDK_CONTROL_MASK | GDK_SHIFT_MASK | GDK_MOD1_MASK)
 #define GET_CURRENT_TAB_WIDGET() GET_NTH_TAB_WIDGET(gtk_notebook_get_current_page(Jumanji.UI.view))
 #define GET_NTH_TAB_WIDGET(n) GTK_SCROLLED_WINDOW(gtk_notebook_get_nth_page(Jumanji.UI.view, n))
@@ -92,6 +110,14 @@ enum mode {
   ALL                = 0x7fffffff
 };
 
+/* statusbar and tabbar updates */
+enum update {
+  UPDATE_STATUS      = 1 << 0,
+  UPDATE_URI         = 1 << 1,
+  UPDATE_POSITION    = 1 << 2,
+  UPDATE_LINK        = 1 << 3
+};
+
 /* typedefs */
 struct CElement
 {
@@ -247,11 +273,116 @@ struct SScript
 {
   char* path;
   char* content;
+  char** patterns;
+  JSStringRef source;
+  GFileMonitor* monitor;
   struct SScript *next;
 };
 
 typedef struct SScript ScriptList;
 
+typedef struct
+{
+  ScriptList* script;
+  char*       path;
+} ScriptPattern;
+
+struct SScriptIndex
+{
+  GHashTable* children;
+  GList*      exact;
+  GList*      wildcard;
+};
+
+typedef struct SScriptIndex ScriptIndex;
+
+typedef struct
+{
+  char*    prefix;
+  char*    suffix;
+  size_t   keyword_length;
+  gboolean host_anchor;
+  gboolean start_anchor;
+  gboolean end_anchor;
+  gboolean exception;
+  int      next;
+} BlockRule;
+
+typedef struct
+{
+  int           fail;
+  int           output;
+  int           dict;
+  int           child;
+  int           sibling;
+  unsigned char c;
+} BlockNode;
+
+typedef struct
+{
+  int     active;
+  GList*  messages;
+  GQueue* pending;
+} TabRequests;
+
+typedef struct
+{
+  WebKitWebView* wv;
+  gchar*         document;
+  gint64         time;
+} RequestTag;
+
+typedef struct
+{
+  GList* addresses;
+  time_t expires;
+} DNSEntry;
+
+typedef struct
+{
+  time_t   expires;
+  gboolean subdomains;
+} HTTPSHost;
+
+typedef struct
+{
+  char*    uri;
+  char*    method;
+  guint    status;
+  goffset  bytes;
+  gboolean cache_hit;
+  gint64   started;
+  gint64   queued;
+  gint64   dns_start;
+  gint64   dns_end;
+  gint64   connect_start;
+  gint64   connect_end;
+  gint64   tls_start;
+  gint64   tls_end;
+  gint64   sent;
+  gint64   wrote;
+  gint64   first_byte;
+  gint64   complete;
+  gboolean reused;
+} LoadEntry;
+
+typedef struct
+{
+  LoadEntry entries[LOAD_TIMELINE_SIZE];
+  int       next;
+  int       count;
+  gint64    page_start;
+} LoadTimeline;
+
+typedef struct
+{
+  int          tab;
+  char*        text;
+  char*        term;
+  GList*       matches;
+  GAsyncQueue* done;
+} SearchAllJob;
+
 struct HList
 {
   char         *scheme;
@@ -325,6 +456,13 @@ struct
     GdkColor notification_w_fg;
     GdkColor notification_w_bg;
     PangoFontDescription *font;
+    GtkRcStyle *statusbar_style;
+    GtkRcStyle *statusbar_ssl_style;
+    GtkRcStyle *inputbar_style;
+    GtkRcStyle *notification_e_style;
+    GtkRcStyle *notification_w_style;
+    int statusbar_ssl;
+    int inputbar_level;
   } Style;
 
   struct
@@ -340,9 +478,21 @@ struct
     GList   *last_closed;
     GList   *allowed_plugins;
     GList   *allowed_plugin_uris;
+    GList   *dirty_tabs;
+    GHashTable        *https_hosts;
+    GtkWidget         *focused_tab;
+    WebKitWebView     *waterfall;
+    WebKitWebView     *waterfall_source;
     HandlerList       *handlers;
     SearchEngineList  *search_engines;
     ScriptList        *scripts;
+    JSStringRef        script_bundle;
+    ScriptIndex       *script_index;
+    GFileMonitor      *rc_monitor;
+    gchar            **rc_lines;
+    JSClassRef         bridge_class;
+    int                script_generation;
+    GThreadPool       *search_pool;
     WebKitWebSettings *browser_settings;
     GdkKeymap         *keymap;
     gboolean init_ui;
@@ -350,7 +500,12 @@ struct
 
   struct
   {
-    SoupSession* session;
+    SoupSession*   session;
+    SoupCache*     cache;
+    SoupCookieJar* cookiejar;
+    char*          cookie_file;
+    guint          cookie_source;
+    GHashTable*    cookie_removed;
   } Soup;
 
   struct
@@ -367,37 +522,183 @@ struct
     BufferCommandList *bcmdlist;
   } Bindings;
 
+  struct
+  {
+    int offset;
+  } Tabbar;
+
+  struct
+  {
+    int count;
+    int length;
+    int active;
+  } Hints;
+
+  struct
+  {
+    GHashTable* hosts;
+    GHashTable* exception_hosts;
+    GArray*     rules;
+    GArray*     nodes;
+  } Blocker;
+
+  struct
+  {
+    GHashTable*    tabs;
+    GHashTable*    tags;
+    WebKitWebView* focused;
+    gint64         pruned;
+  } Scheduler;
+
+  struct
+  {
+    GHashTable* hosts;
+    gint64      last;
+    gchar*      pending;
+    guint       source;
+  } Prefetch;
+
+  struct
+  {
+    GtkWidget*     window;
+    WebKitWebView* view;
+    char*          uri;
+    guint          source;
+  } Prerender;
+
+  struct
+  {
+    GHashTable*     cache;
+    GResolverClass* parent;
+    int             hits;
+    int             negative_hits;
+    int             expired;
+    int             misses;
+  } DNS;
+
+  struct
+  {
+    int      flags;
+    guint    source;
+    GTimer  *timer;
+    gchar   *link;
+  } Update;
+
 } Jumanji;
 
 /* function declarations */
+void add_block_rule(char*);
 void add_marker(int);
+void apply_configuration(char*);
 gboolean auto_save(gpointer);
+gboolean call_script_function(char*, char*, char**);
 void change_mode(int);
+void compile_block_rules();
+JSObjectRef create_bridge(WebKitWebView*, JSContextRef);
+GList* copy_addresses(GList*);
+void clear_script_functions(WebKitWebView*, JSContextRef);
+void append_json_string(GString*, const char*);
+GtkRcStyle* create_rc_style(GdkColor*, GdkColor*, GdkColor*, GdkColor*);
+GtkWidget* create_blank_tab(gboolean);
 GtkWidget* create_tab(char*, gboolean);
+GtkWidget* create_web_view();
+void discard_prerender();
 void eval_marker(int);
+gboolean export_load_timeline(WebKitWebView*, const char*);
+char* expand_uri(char*);
+void flush_cookies();
+void free_dns_entry(gpointer);
+void free_request_tag(RequestTag*);
+void free_load_timeline(gpointer);
+void free_script_index(ScriptIndex*);
+void forget_request_tags(WebKitWebView*, gint64);
+void free_tab_requests(gpointer);
+int get_block_node_child(int, unsigned char);
+LoadTimeline* get_load_timeline(WebKitWebView*);
+int get_tab_width();
+WebKitWebSettings* get_local_settings(WebKitWebView*);
+void sync_local_settings(const char*);
+JSObjectRef get_script_function(WebKitWebView*, JSContextRef, char*);
+gboolean get_hint_range(int*, int*);
+GList* get_site_scripts(const char*);
+gint compare_load_entries(gconstpointer, gconstpointer);
+gchar* get_request_key(SoupURI*);
+char* get_text_snapshot(WebKitWebView*);
 void init_data();
 void init_directories();
+void init_dns_cache();
 void init_jumanji();
 void init_keylist();
 void init_settings();
 void init_ui();
-void load_all_scripts();
+void inject_bridge(WebKitWebView*, JSContextRef);
+void index_script(ScriptList*, char*);
+void inject_scripts(WebKitWebFrame*);
+void load_cookies(const char*);
+void load_https_hosts(const char*);
+int lock_file(const char*);
+gboolean lookup_dns_cache(const char*, GList**);
+void load_hints(WebKitWebView*, JSContextRef, GHashTable*);
+gboolean is_blocked(const char*);
+gboolean is_https_host(const char*);
+void mark_tab_dirty(GtkWidget*);
+void mark_tabs_dirty(int, int);
+gboolean match_block_host(GHashTable*, const char*, size_t);
+gboolean match_block_pattern(const char*, const char*, const char*, gboolean, gboolean);
+const char* match_block_segment(const char*, size_t, const char*, const char*);
+gboolean match_block_rules(const char*, const char*, size_t, gboolean);
 void notify(int, char*);
 void new_window(char*);
 void out_of_memory();
+void prefetch_host(const char*);
+gboolean prefetch_uri(const char*);
+gboolean remove_prefetched_host(gpointer, gpointer, gpointer);
+void prerender_uri(const char*);
 void open_uri(WebKitWebView*, char*);
+void monitor_script(ScriptList*);
 void read_configuration();
+void resolver_class_init(gpointer, gpointer);
+GList* resolver_lookup_by_name(GResolver*, const gchar*, GCancellable*, GError**);
+void resolver_lookup_by_name_async(GResolver*, const gchar*, GCancellable*, GAsyncReadyCallback, gpointer);
+GList* resolver_lookup_by_name_finish(GResolver*, GAsyncResult*, GError**);
+void run_pending_requests(WebKitWebView*);
 char* read_file(const char*);
+gboolean save_cookies(gpointer);
+void save_dns_cache();
+void save_https_hosts();
+void set_https_host(const char*, time_t, gboolean);
+void unlock_file(int);
+void set_request_priority(WebKitWebView*, SoupMessagePriority);
+void store_dns_entry(const char*, GList*, GError*);
+gboolean swap_prerendered(WebKitWebView*, const char*);
+void show_load_waterfall(WebKitWebView*);
+void tag_request(WebKitWebView*, const char*, const char*);
+WebKitWebView* take_request_tag(SoupMessage*);
+void remove_tab(int);
 char* reference_to_string(JSContextRef, JSValueRef);
 void run_script(char*, char**, char**);
+void schedule_update(int);
 gboolean search_and_highlight(Argument*);
+GList* search_all_tabs(char*);
+void search_all_worker(gpointer, gpointer);
+int get_search_delay(WebKitWebView*);
 gboolean sessionload(char*);
 gboolean sessionsave(char*);
 gboolean sessionswitch(char*);
+gboolean show_hints();
 gboolean scheme_handler(char*);
+gboolean set_option(int, char**, gboolean);
 void set_completion_row_color(GtkBox*, int, int);
+void set_inputbar_style(int);
+void set_statusbar_style(gboolean);
 void switch_view(GtkWidget*);
+void update_disk_cache();
+void update_hints(int, int);
+void update_script_bundle();
 void update_status();
+void update_tab(GtkWidget*);
+void set_tabbar_offset(int);
+void update_tabbar_offset(int);
 void update_uri();
 void update_position();
 GtkEventBox* create_completion_row(GtkBox*, char*, char*, gboolean);
@@ -442,6 +743,7 @@ void isc_string_manipulation(Argument*);
 gboolean cmd_back(int, char**);
 gboolean cmd_bmap(int, char**);
 gboolean cmd_bookmark(int, char**);
+gboolean cmd_dnsstats(int, char**);
 gboolean cmd_forward(int, char**);
 gboolean cmd_map(int, char**);
 gboolean cmd_open(int, char**);
@@ -454,11 +756,15 @@ gboolean cmd_reload_all(int, char**);
 gboolean cmd_saveas(int, char**);
 gboolean cmd_script(int, char**);
 gboolean cmd_search_engine(int, char**);
+gboolean cmd_searchall(int, char**);
+gboolean cmd_searchstats(int, char**);
 gboolean cmd_sessionload(int, char**);
 gboolean cmd_sessionsave(int, char**);
 gboolean cmd_sessionswitch(int, char**);
 gboolean cmd_set(int, char**);
+gboolean cmd_setlocal(int, char**);
 gboolean cmd_stop(int, char**);
+gboolean cmd_loadstats(int, char**);
 gboolean cmd_tabopen(int, char**);
 gboolean cmd_schemehandler(int, char**);
 gboolean cmd_winopen(int, char**);
@@ -466,6 +772,7 @@ gboolean cmd_write(int, char**);
 
 /* completion commands */
 Completion* cc_open(char*);
+Completion* cc_searchall(char*);
 Completion* cc_session(char*);
 Completion* cc_set(char*);
 
@@ -489,27 +796,54 @@ gboolean scmd_search(char*, Argument*, gboolean);
 /* callback declarations */
 UniqueResponse cb_app_message_received(UniqueApp*, gint, UniqueMessageData*, guint, gpointer);
 gboolean cb_blank();
+void cb_config_changed(GFileMonitor*, GFile*, GFile*, GFileMonitorEvent, gpointer);
+void cb_config_loaded(GObject*, GAsyncResult*, gpointer);
+void cb_cookie_changed(SoupCookieJar*, SoupCookie*, SoupCookie*, gpointer);
 gboolean cb_destroy(GtkWidget*, gpointer);
+void cb_message_finished(SoupMessage*, gpointer);
+void cb_message_got_chunk(SoupMessage*, SoupBuffer*, gpointer);
+void cb_message_got_headers(SoupMessage*, gpointer);
+void cb_message_network_event(SoupMessage*, GSocketClientEvent, GIOStream*, gpointer);
+void cb_message_wrote_body(SoupMessage*, gpointer);
+gboolean cb_prefetch_timeout(gpointer);
+gboolean cb_prerender_timeout(gpointer);
+gboolean cb_release_web_view(gpointer);
+void cb_resolver_lookup_done(GObject*, GAsyncResult*, gpointer);
+void cb_session_request_queued(SoupSession*, SoupMessage*, gpointer);
+void cb_session_request_started(SoupSession*, SoupMessage*, SoupSocket*, gpointer);
 gboolean cb_inputbar_kb_pressed(GtkWidget*, GdkEventKey*, gpointer);
 void cb_inputbar_changed(GtkEditable*, gpointer);
 gboolean cb_inputbar_activate(GtkEntry*, gpointer);
+JSValueRef cb_js_open_uri(JSContextRef, JSObjectRef, JSObjectRef, size_t, const JSValueRef[], JSValueRef*);
+JSValueRef cb_js_set_mode(JSContextRef, JSObjectRef, JSObjectRef, size_t, const JSValueRef[], JSValueRef*);
 gboolean cb_tab_kb_pressed(GtkWidget*, GdkEventKey*, gpointer);
+gboolean cb_tabbar_expose(GtkWidget*, GdkEventExpose*, gpointer);
+gboolean cb_tabbar_scroll(GtkWidget*, GdkEventScroll*, gpointer);
+void cb_tabbar_size_allocate(GtkWidget*, GtkAllocation*, gpointer);
+gboolean cb_update_status(gpointer);
+void cb_view_switch_page(GtkNotebook*, gpointer, guint, gpointer);
+void cb_script_changed(GFileMonitor*, GFile*, GFile*, GFileMonitorEvent, gpointer);
+void cb_script_loaded(GObject*, GAsyncResult*, gpointer);
 GtkWidget* cb_wv_block_plugin(WebKitWebView*, gchar*, gchar*, GHashTable*, gpointer);
 gboolean cb_wv_button_release_event(GtkWidget*, GdkEvent*, gpointer);
-gboolean cb_wv_console(WebKitWebView*, char*, int, char*, gpointer);
 GtkWidget* cb_wv_create_web_view(WebKitWebView*, WebKitWebFrame*, gpointer);
 gboolean cb_wv_download_request(WebKitWebView*, WebKitDownload*, gpointer);
 gboolean cb_wv_hover_link(WebKitWebView*, char*, char*, gpointer);
 WebKitWebView* cb_wv_inspector_view(WebKitWebInspector*, WebKitWebView*, gpointer);
 gboolean cb_wv_mimetype_policy_decision(WebKitWebView*, WebKitWebFrame*, WebKitNetworkRequest*, char*, WebKitWebPolicyDecision*, gpointer);
 gboolean cb_wv_notify_progress(WebKitWebView*, GParamSpec*, gpointer);
+void cb_wv_load_committed(WebKitWebView*, WebKitWebFrame*, gpointer);
 gboolean cb_wv_notify_title(WebKitWebView*, GParamSpec*, gpointer);
+void cb_wv_resource_request_starting(WebKitWebView*, WebKitWebFrame*, WebKitWebResource*, WebKitNetworkRequest*, WebKitNetworkResponse*, gpointer);
 gboolean cb_wv_nav_policy_decision(WebKitWebView*, WebKitWebFrame*, WebKitNetworkRequest*, WebKitWebNavigationAction*, WebKitWebPolicyDecision*, gpointer);
 gboolean cb_wv_scrolled(GtkAdjustment*, gpointer);
 gboolean cb_wv_unblock_plugin(GtkWidget*, GdkEventButton*, gpointer);
 gboolean cb_wv_window_policy_decision(WebKitWebView*, WebKitWebFrame*, WebKitNetworkRequest*, WebKitWebNavigationAction*, WebKitWebPolicyDecision*, gpointer);
 gboolean cb_wv_window_object_cleared(WebKitWebView*, WebKitWebFrame*, gpointer, gpointer, gpointer);
 
+/* search (special)command global variables */
+char* search_item = NULL;
+
 /* configuration */
 #include "config.h"
 
@@ -563,6 +897,194 @@ auto_save(gpointer UNUSED(data))
   return TRUE;
 }
 
+void
+flush_cookies()
+{
+  if(!Jumanji.Soup.cookie_source)
+    return;
+
+  g_source_remove(Jumanji.Soup.cookie_source);
+  save_cookies(NULL);
+}
+
+int
+lock_file(const char* filename)
+{
+  /* the lock is taken on a separate file, the data file itself is
+   * replaced atomically by g_file_set_contents() */
+  gchar* lock_name = g_strconcat(filename, ".lock", NULL);
+  int    fd        = open(lock_name, O_RDWR | O_CREAT, 0600);
+  g_free(lock_name);
+
+  if(fd != -1 && flock(fd, LOCK_EX) == -1)
+  {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+void
+unlock_file(int fd)
+{
+  if(fd == -1)
+    return;
+
+  flock(fd, LOCK_UN);
+  close(fd);
+}
+
+void
+load_cookies(const char* filename)
+{
+  char* content = NULL;
+
+  if(!g_file_get_contents(filename, &content, NULL, NULL))
+    return;
+
+  gchar **lines = g_strsplit(content, "\n", -1);
+  time_t  now   = time(NULL);
+
+  for(int i = 0; lines[i]; i++)
+  {
+    char*    line      = lines[i];
+    gboolean http_only = FALSE;
+
+    if(g_str_has_prefix(line, "#HttpOnly_"))
+    {
+      http_only = TRUE;
+      line     += strlen("#HttpOnly_");
+    }
+    else if(line[0] == '#')
+      continue;
+
+    /* domain, subdomains, path, secure, expires, name, value */
+    gchar **fields = g_strsplit(line, "\t", -1);
+
+    if(g_strv_length(fields) == 7)
+    {
+      time_t expires = strtoul(fields[4], NULL, 10);
+
+      if(expires > now)
+      {
+        SoupCookie* cookie = soup_cookie_new(fields[5], fields[6], fields[0], fields[2], expires - now);
+        soup_cookie_set_secure(cookie, !strcmp(fields[3], "TRUE"));
+        soup_cookie_set_http_only(cookie, http_only);
+
+        soup_cookie_jar_add_cookie(Jumanji.Soup.cookiejar, cookie);
+      }
+    }
+
+    g_strfreev(fields);
+  }
+
+  g_strfreev(lines);
+  g_free(content);
+}
+
+gboolean
+save_cookies(gpointer UNUSED(data))
+{
+  /* other jumanji instances write the same file, keep their cookies */
+  int         lock    = lock_file(Jumanji.Soup.cookie_file);
+  GHashTable* lines   = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  GList*      keys    = NULL;
+  char*       current = NULL;
+  time_t      now     = time(NULL);
+
+  if(g_file_get_contents(Jumanji.Soup.cookie_file, &current, NULL, NULL))
+  {
+    gchar** entries = g_strsplit(current, "\n", -1);
+
+    for(int i = 0; entries[i]; i++)
+    {
+      char* line = entries[i];
+      if(g_str_has_prefix(line, "#HttpOnly_"))
+        line += strlen("#HttpOnly_");
+      else if(line[0] == '#')
+        continue;
+
+      gchar** fields = g_strsplit(line, "\t", -1);
+      if(g_strv_length(fields) == 7 && (time_t) strtoul(fields[4], NULL, 10) > now)
+      {
+        gchar* key = g_strdup_printf("%s\t%s\t%s", fields[0], fields[2], fields[5]);
+
+        if(!g_hash_table_lookup(Jumanji.Soup.cookie_removed, key) && !g_hash_table_lookup(lines, key))
+        {
+          keys = g_list_append(keys, key);
+          g_hash_table_insert(lines, g_strdup(key), g_strdup(entries[i]));
+        }
+        else
+          g_free(key);
+      }
+
+      g_strfreev(fields);
+    }
+
+    g_strfreev(entries);
+    g_free(current);
+  }
+
+  /* our own cookies replace those of the file, expired ones are dropped */
+  GSList* cookies = soup_cookie_jar_all_cookies(Jumanji.Soup.cookiejar);
+
+  for(GSList* list = cookies; list; list = g_slist_next(list))
+  {
+    SoupCookie* cookie = (SoupCookie*) list->data;
+
+    if(cookie->expires && soup_date_is_past(cookie->expires))
+      soup_cookie_jar_delete_cookie(Jumanji.Soup.cookiejar, cookie);
+    else if(cookie->expires)
+    {
+      gchar* key  = g_strdup_printf("%s\t%s\t%s", cookie->domain, cookie->path, cookie->name);
+      gchar* line = g_strdup_printf("%s%s\t%s\t%s\t%s\t%lu\t%s\t%s",
+          cookie->http_only ? "#HttpOnly_" : "",
+          cookie->domain,
+          cookie->domain[0] == '.' ? "TRUE" : "FALSE",
+          cookie->path,
+          cookie->secure ? "TRUE" : "FALSE",
+          (unsigned long) soup_date_to_time_t(cookie->expires),
+          cookie->name,
+          cookie->value);
+
+      if(!g_hash_table_lookup(lines, key))
+        keys = g_list_append(keys, g_strdup(key));
+
+      g_hash_table_insert(lines, key, line);
+    }
+
+    soup_cookie_free(cookie);
+  }
+
+  g_slist_free(cookies);
+
+  /* write the netscape format of wget --load-cookies */
+  GString* content = g_string_new(NULL);
+
+  for(GList* list = keys; list; list = g_list_next(list))
+  {
+    g_string_append(content, g_hash_table_lookup(lines, list->data));
+    g_string_append_c(content, '\n');
+    g_free(list->data);
+  }
+
+  if(g_file_set_contents(Jumanji.Soup.cookie_file, content->str, -1, NULL))
+    g_hash_table_remove_all(Jumanji.Soup.cookie_removed);
+  else
+    notify(WARNING, "Could not write cookies");
+
+  unlock_file(lock);
+
+  g_list_free(keys);
+  g_hash_table_destroy(lines);
+  g_string_free(content, TRUE);
+
+  Jumanji.Soup.cookie_source = 0;
+
+  return FALSE;
+}
+
 void
 change_mode(int mode)
 {
@@ -601,14 +1123,62 @@ change_mode(int mode)
   notify(DEFAULT, mode_text);
 }
 
+GtkRcStyle*
+create_rc_style(GdkColor* fg, GdkColor* bg, GdkColor* text, GdkColor* base)
+{
+  GtkRcStyle* style = gtk_rc_style_new();
+
+  if(fg)
+  {
+    style->fg[GTK_STATE_NORMAL] = *fg;
+    style->color_flags[GTK_STATE_NORMAL] |= GTK_RC_FG;
+  }
+
+  if(bg)
+  {
+    style->bg[GTK_STATE_NORMAL] = *bg;
+    style->color_flags[GTK_STATE_NORMAL] |= GTK_RC_BG;
+  }
+
+  if(text)
+  {
+    style->text[GTK_STATE_NORMAL] = *text;
+    style->color_flags[GTK_STATE_NORMAL] |= GTK_RC_TEXT;
+  }
+
+  if(base)
+  {
+    style->base[GTK_STATE_NORMAL] = *base;
+    style->color_flags[GTK_STATE_NORMAL] |= GTK_RC_BASE;
+  }
+
+  style->font_desc = pango_font_description_copy(Jumanji.Style.font);
+
+  return style;
+}
+
 GtkWidget*
 create_tab(char* uri, gboolean background)
 {
   if(!uri)
     return NULL;
 
+  GtkWidget* wv = create_blank_tab(background);
+  if(!wv)
+    return NULL;
+
+  /* open uri, a prerendered view may take the place of the new one */
+  GtkWidget* tab = gtk_widget_get_parent(wv);
+  open_uri(WEBKIT_WEB_VIEW(wv), uri);
+
+  return GTK_WIDGET(GET_WEBVIEW(tab));
+}
+
+GtkWidget*
+create_blank_tab(gboolean background)
+{
   GtkWidget *tab = gtk_scrolled_window_new(NULL, NULL);
-  GtkWidget *wv  = webkit_web_view_new();
+  GtkWidget *wv  = create_web_view();
 
   if(!tab || !wv)
     return NULL;
@@ -619,86 +1189,100 @@ create_tab(char* uri, gboolean background)
   if(show_scrollbars)
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
   else
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab), GTK_POLICY_NEVER, GTK_POLICY_NEVER);
+
+  GtkAdjustment* adjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(tab));
+
+  /* connect tab callbacks */
+  g_signal_connect(G_OBJECT(tab),        "key-press-event", G_CALLBACK(cb_tab_kb_pressed), NULL);
+  g_signal_connect(G_OBJECT(adjustment), "value-changed",   G_CALLBACK(cb_wv_scrolled),    NULL);
+
+  gtk_container_add(GTK_CONTAINER(tab), wv);
+  gtk_widget_show_all(tab);
+  gtk_notebook_insert_page(Jumanji.UI.view, tab, NULL, position);
+
+  if(!background)
+    gtk_notebook_set_current_page(Jumanji.UI.view, position);
+
+  /* create tab label, the tabbar renders it from the cached layout */
+  PangoLayout* layout = gtk_widget_create_pango_layout(Jumanji.UI.tabbar, NULL);
+  pango_layout_set_font_description(layout, Jumanji.Style.font);
+  pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+
+  g_object_set_data_full(G_OBJECT(tab), "layout", layout, g_object_unref);
+
+  /* the new tab and all following tabs have to be relabeled */
+  mark_tabs_dirty(gtk_notebook_page_num(Jumanji.UI.view, tab), -1);
+  gtk_widget_queue_draw(Jumanji.UI.tabbar);
+
+  gtk_widget_grab_focus(GTK_WIDGET(GET_CURRENT_TAB_WIDGET()));
+
+  return wv;
+}
+
+GtkWidget*
+create_web_view()
+{
+  GtkWidget *wv = webkit_web_view_new();
+
+  if(!wv)
+    return NULL;
+
+  if(!show_scrollbars)
   {
     WebKitWebFrame* mf = webkit_web_view_get_main_frame(WEBKIT_WEB_VIEW(wv));
     g_signal_connect(G_OBJECT(mf),  "scrollbars-policy-changed", G_CALLBACK(cb_blank), NULL);
-
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab), GTK_POLICY_NEVER, GTK_POLICY_NEVER);
   }
 
-  GtkAdjustment* adjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(tab));
-
   /* connect webview callbacks */
-  g_signal_connect(G_OBJECT(wv),  "console-message",                      G_CALLBACK(cb_wv_console),                  NULL);
   g_signal_connect(G_OBJECT(wv),  "create-plugin-widget",                 G_CALLBACK(cb_wv_block_plugin),             NULL);
   g_signal_connect(G_OBJECT(wv),  "create-web-view",                      G_CALLBACK(cb_wv_create_web_view),          NULL);
   g_signal_connect(G_OBJECT(wv),  "download-requested",                   G_CALLBACK(cb_wv_download_request),         NULL);
   g_signal_connect(G_OBJECT(wv),  "button-release-event",                 G_CALLBACK(cb_wv_button_release_event),     NULL);
   g_signal_connect(G_OBJECT(wv),  "hovering-over-link",                   G_CALLBACK(cb_wv_hover_link),               NULL);
+  g_signal_connect(G_OBJECT(wv),  "load-committed",                       G_CALLBACK(cb_wv_load_committed),           NULL);
   g_signal_connect(G_OBJECT(wv),  "mime-type-policy-decision-requested",  G_CALLBACK(cb_wv_mimetype_policy_decision), NULL);
   g_signal_connect(G_OBJECT(wv),  "navigation-policy-decision-requested", G_CALLBACK(cb_wv_nav_policy_decision),      NULL);
   g_signal_connect(G_OBJECT(wv),  "new-window-policy-decision-requested", G_CALLBACK(cb_wv_window_policy_decision),   NULL);
   g_signal_connect(G_OBJECT(wv),  "notify::progress",                     G_CALLBACK(cb_wv_notify_progress),          NULL);
   g_signal_connect(G_OBJECT(wv),  "notify::title",                        G_CALLBACK(cb_wv_notify_title),             NULL);
+  g_signal_connect(G_OBJECT(wv),  "resource-request-starting",            G_CALLBACK(cb_wv_resource_request_starting), NULL);
   g_signal_connect(G_OBJECT(wv),  "window-object-cleared",                G_CALLBACK(cb_wv_window_object_cleared),    NULL);
 
-  /* connect tab callbacks */
-  g_signal_connect(G_OBJECT(tab),        "key-press-event", G_CALLBACK(cb_tab_kb_pressed), NULL);
-  g_signal_connect(G_OBJECT(adjustment), "value-changed",   G_CALLBACK(cb_wv_scrolled),    NULL);
-
   /* set default values */
-  g_object_set_data(G_OBJECT(wv), "loaded_scripts", 0);
   g_object_set(G_OBJECT(wv), "full-content-zoom", full_content_zoom, NULL);
 
-  /* apply browser setting */
-  webkit_web_view_set_settings(WEBKIT_WEB_VIEW(wv), webkit_web_settings_copy(Jumanji.Global.browser_settings));
+  /* share browser settings, tab-local copies are created by cmd_setlocal */
+  webkit_web_view_set_settings(WEBKIT_WEB_VIEW(wv), Jumanji.Global.browser_settings);
 
   /* set web inspector */
   WebKitWebInspector* web_inspector = webkit_web_view_get_inspector(WEBKIT_WEB_VIEW(wv));
   g_signal_connect(G_OBJECT(web_inspector), "inspect-web-view", G_CALLBACK(cb_wv_inspector_view), NULL);
 
-  gtk_container_add(GTK_CONTAINER(tab), wv);
-  gtk_widget_show_all(tab);
-  gtk_notebook_insert_page(Jumanji.UI.view, tab, NULL, position);
-
-  if(!background)
-    gtk_notebook_set_current_page(Jumanji.UI.view, position);
-
-  /* create tab label */
-  GtkWidget *tab_label = gtk_label_new(NULL);
-  gtk_label_set_width_chars(GTK_LABEL(tab_label), 1.0);
-  gtk_misc_set_alignment(    GTK_MISC(tab_label), 0.0, 0.0);
-  gtk_misc_set_padding(      GTK_MISC(tab_label), 4.0, 2.0);
-
-  /* create tab container */
-  GtkWidget *tev_box = gtk_event_box_new();
-  GtkWidget *tab_box = gtk_hbox_new(FALSE, 0);
-  GtkWidget *tab_sep = gtk_vseparator_new();
-
-  /* tab style */
-  gtk_widget_modify_font(tab_label, Jumanji.Style.font);
-  gtk_widget_modify_bg(tab_sep,  GTK_STATE_NORMAL, &(Jumanji.Style.tabbar_separator));
-
-  /* build tab */
-  gtk_box_pack_start(GTK_BOX(tab_box), tab_label,  TRUE,  TRUE, 0);
-  gtk_box_pack_start(GTK_BOX(tab_box), tab_sep,   FALSE, FALSE, 0);
-  gtk_container_add(GTK_CONTAINER(tev_box), tab_box);
+  return wv;
+}
 
-  /* add to tabbar */
-  gtk_box_pack_start(GTK_BOX(Jumanji.UI.tabbar), tev_box, TRUE, TRUE, 0);
-  gtk_box_reorder_child(GTK_BOX(Jumanji.UI.tabbar), tev_box, position);
-  gtk_widget_show_all(tev_box);
+void
+discard_prerender()
+{
+  if(Jumanji.Prerender.source)
+    g_source_remove(Jumanji.Prerender.source);
 
-  /* add reference to tab */
-  g_object_set_data(G_OBJECT(tab), "tab",   (gpointer) tev_box);
-  g_object_set_data(G_OBJECT(tab), "label", (gpointer) tab_label);
+  if(Jumanji.Prerender.view)
+  {
+    g_hash_table_remove(Jumanji.Scheduler.tabs, Jumanji.Prerender.view);
+    forget_request_tags(Jumanji.Prerender.view, 0);
+  }
 
-  gtk_widget_grab_focus(GTK_WIDGET(GET_CURRENT_TAB_WIDGET()));
+  if(Jumanji.Prerender.window)
+    gtk_widget_destroy(Jumanji.Prerender.window);
 
-  /* open uri */
-  open_uri(WEBKIT_WEB_VIEW(wv), uri);
+  g_free(Jumanji.Prerender.uri);
 
-  return wv;
+  Jumanji.Prerender.window = NULL;
+  Jumanji.Prerender.view   = NULL;
+  Jumanji.Prerender.uri    = NULL;
+  Jumanji.Prerender.source = 0;
 }
 
 
@@ -722,38 +1306,1235 @@ eval_marker(int id)
       adjustment = gtk_scrolled_window_get_hadjustment(GET_CURRENT_TAB_WIDGET());
       gtk_adjustment_set_value(adjustment, marker->hadjustment);
       webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), marker->zoom_level);
-      update_status();
+      schedule_update(UPDATE_STATUS);
       return;
     }
   }
 }
 
-void
-init_data()
+WebKitWebSettings*
+get_local_settings(WebKitWebView* wv)
 {
-  /* read bookmarks */
-  char* bookmark_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_BOOKMARKS, NULL);
+  /* tabs share the global settings until they receive a tab-local override,
+   * the names of the overridden settings are kept with the copy */
+  if(!g_object_get_data(G_OBJECT(wv), "local_overrides"))
+  {
+    WebKitWebSettings* local_settings = webkit_web_settings_copy(webkit_web_view_get_settings(wv));
+    webkit_web_view_set_settings(wv, local_settings);
+    g_object_unref(local_settings);
 
-  if(!bookmark_file)
+    g_object_set_data_full(G_OBJECT(wv), "local_overrides", g_hash_table_new(g_str_hash, g_str_equal),
+        (GDestroyNotify) g_hash_table_destroy);
+  }
+
+  return webkit_web_view_get_settings(wv);
+}
+
+void
+sync_local_settings(const char* name)
+{
+  GParamSpec* pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(Jumanji.Global.browser_settings), name);
+  if(!pspec)
     return;
 
-  if(g_file_test(bookmark_file, G_FILE_TEST_IS_REGULAR))
-  {
-    char* content = NULL;
+  GValue value = {0};
+  g_value_init(&value, G_PARAM_SPEC_VALUE_TYPE(pspec));
+  g_object_get_property(G_OBJECT(Jumanji.Global.browser_settings), name, &value);
 
-    if(g_file_get_contents(bookmark_file, &content, NULL, NULL))
-    {
-      gchar **lines = g_strsplit(content, "\n", -1);
-      int     n     = g_strv_length(lines) - 1;
+  /* tabs with local settings follow the global value unless they override it */
+  for(int i = 0; i < gtk_notebook_get_n_pages(Jumanji.UI.view); i++)
+  {
+    WebKitWebView* wv        = GET_NTH_TAB(i);
+    GHashTable*    overrides = g_object_get_data(G_OBJECT(wv), "local_overrides");
 
-      int i;
-      for(i = 0; i < n; i++)
-      {
-        if(!strlen(lines[i]))
-          continue;
+    if(overrides && !g_hash_table_lookup(overrides, name))
+      g_object_set_property(G_OBJECT(webkit_web_view_get_settings(wv)), name, &value);
+  }
 
-        Jumanji.Global.bookmarks = g_list_append(Jumanji.Global.bookmarks, lines[i]);
-      }
+  g_value_unset(&value);
+}
+
+void
+add_block_rule(char* line)
+{
+  /* comments and element hiding rules */
+  if(!strlen(line) || line[0] == '!' || line[0] == '[' || strstr(line, "##") || strstr(line, "#@#"))
+    return;
+
+  BlockRule rule = {NULL, NULL, 0, FALSE, FALSE, FALSE, FALSE, -1};
+
+  if(g_str_has_prefix(line, "@@"))
+  {
+    rule.exception = TRUE;
+    line += 2;
+  }
+
+  /* options depend on the request context, these rules are skipped */
+  if(strchr(line, '$'))
+    return;
+
+  gchar* pattern = g_ascii_strdown(line, -1);
+  char*  p       = pattern;
+
+  if(g_str_has_prefix(p, "||"))
+  {
+    rule.host_anchor = TRUE;
+    p += 2;
+  }
+  else if(p[0] == '|')
+  {
+    rule.start_anchor = TRUE;
+    p++;
+  }
+
+  size_t length = strlen(p);
+  if(length && p[length - 1] == '|')
+  {
+    rule.end_anchor = TRUE;
+    p[--length] = '\0';
+  }
+
+  /* plain ||host^ rules go into the host table */
+  size_t host_length = strcspn(p, "/^*");
+  if(rule.host_anchor && host_length && (p[host_length] == '\0' || !strcmp(p + host_length, "^")))
+  {
+    g_hash_table_insert(rule.exception ? Jumanji.Blocker.exception_hosts : Jumanji.Blocker.hosts,
+        g_strndup(p, host_length), GINT_TO_POINTER(1));
+    g_free(pattern);
+    return;
+  }
+
+  /* the longest literal part of the pattern is the keyword of the automaton */
+  char*  keyword        = NULL;
+  size_t keyword_length = 0;
+
+  for(char* k = p; *k; )
+  {
+    size_t n = strcspn(k, "*^");
+    if(n > keyword_length)
+    {
+      keyword        = k;
+      keyword_length = n;
+    }
+
+    k += n ? n : 1;
+  }
+
+  if(!keyword)
+  {
+    g_free(pattern);
+    return;
+  }
+
+  int node = 0;
+  for(size_t i = 0; i < keyword_length; i++)
+  {
+    int child = get_block_node_child(node, keyword[i]);
+
+    if(child == -1)
+    {
+      BlockNode new_node = {0, -1, -1, -1, BLOCK_NODE(node).child, keyword[i]};
+      g_array_append_val(Jumanji.Blocker.nodes, new_node);
+
+      child = Jumanji.Blocker.nodes->len - 1;
+      BLOCK_NODE(node).child = child;
+    }
+
+    node = child;
+  }
+
+  /* the rule is verified around the position its keyword was found at */
+  rule.prefix         = g_strndup(p, keyword - p);
+  rule.suffix         = g_strdup(keyword + keyword_length);
+  rule.keyword_length = keyword_length;
+  rule.next           = BLOCK_NODE(node).output;
+  g_array_append_val(Jumanji.Blocker.rules, rule);
+  BLOCK_NODE(node).output = Jumanji.Blocker.rules->len - 1;
+
+  g_free(pattern);
+}
+
+void
+compile_block_rules()
+{
+  /* breadth first search to compute the failure links of the automaton */
+  GQueue* queue = g_queue_new();
+
+  for(int child = BLOCK_NODE(0).child; child != -1; child = BLOCK_NODE(child).sibling)
+  {
+    BLOCK_NODE(child).fail = 0;
+    BLOCK_NODE(child).dict = -1;
+    g_queue_push_tail(queue, GINT_TO_POINTER(child));
+  }
+
+  while(!g_queue_is_empty(queue))
+  {
+    int node = GPOINTER_TO_INT(g_queue_pop_head(queue));
+
+    for(int child = BLOCK_NODE(node).child; child != -1; child = BLOCK_NODE(child).sibling)
+    {
+      unsigned char c    = BLOCK_NODE(child).c;
+      int           fail = BLOCK_NODE(node).fail;
+      int           next;
+
+      while((next = get_block_node_child(fail, c)) == -1 && fail != 0)
+        fail = BLOCK_NODE(fail).fail;
+
+      BLOCK_NODE(child).fail = (next != -1) ? next : 0;
+
+      fail = BLOCK_NODE(child).fail;
+      BLOCK_NODE(child).dict = (BLOCK_NODE(fail).output != -1) ? fail : BLOCK_NODE(fail).dict;
+
+      g_queue_push_tail(queue, GINT_TO_POINTER(child));
+    }
+  }
+
+  g_queue_free(queue);
+}
+
+int
+get_block_node_child(int node, unsigned char c)
+{
+  for(int child = BLOCK_NODE(node).child; child != -1; child = BLOCK_NODE(child).sibling)
+    if(BLOCK_NODE(child).c == c)
+      return child;
+
+  return -1;
+}
+
+gboolean
+is_blocked(const char* uri)
+{
+  if(!g_str_has_prefix(uri, "http://") && !g_str_has_prefix(uri, "https://"))
+    return FALSE;
+
+  /* the uri is lowercase, the host is a part of it */
+  gchar* lowercase_uri = g_ascii_strdown(uri, -1);
+  char*  host          = strstr(lowercase_uri, "://") + 3;
+  size_t host_length   = strcspn(host, "/:?#");
+
+  gboolean blocked = match_block_host(Jumanji.Blocker.hosts, host, host_length) ||
+    match_block_rules(lowercase_uri, host, host_length, FALSE);
+
+  if(blocked && (match_block_host(Jumanji.Blocker.exception_hosts, host, host_length) ||
+      match_block_rules(lowercase_uri, host, host_length, TRUE)))
+    blocked = FALSE;
+
+  g_free(lowercase_uri);
+
+  return blocked;
+}
+
+void
+free_tab_requests(gpointer data)
+{
+  TabRequests* requests = (TabRequests*) data;
+
+  /* let the web view cancel the requests which are still held back */
+  while(!g_queue_is_empty(requests->pending))
+    soup_session_unpause_message(Jumanji.Soup.session, g_queue_pop_head(requests->pending));
+
+  g_list_free(requests->messages);
+  g_queue_free(requests->pending);
+  free(requests);
+}
+
+void
+run_pending_requests(WebKitWebView* wv)
+{
+  TabRequests* requests = g_hash_table_lookup(Jumanji.Scheduler.tabs, wv);
+  if(!requests)
+    return;
+
+  while(!g_queue_is_empty(requests->pending) &&
+      (wv == Jumanji.Scheduler.focused || requests->active < background_connections))
+  {
+    SoupMessage* message = g_queue_pop_head(requests->pending);
+
+    requests->active++;
+    soup_session_unpause_message(Jumanji.Soup.session, message);
+  }
+}
+
+gchar*
+get_request_key(SoupURI* uri)
+{
+  /* webkit drops the fragment before it hands a request to libsoup */
+  SoupURI* copy = soup_uri_copy(uri);
+  soup_uri_set_fragment(copy, NULL);
+
+  gchar* key = soup_uri_to_string(copy, FALSE);
+  soup_uri_free(copy);
+
+  return key;
+}
+
+void
+tag_request(WebKitWebView* wv, const char* uri, const char* document)
+{
+  SoupURI* soup_uri = uri ? soup_uri_new(uri) : NULL;
+  if(!soup_uri)
+    return;
+
+  /* tags of requests which never reach the session, like hits of the
+   * memory cache of webkit, expire and are swept from time to time */
+  gint64 now = g_get_monotonic_time();
+  if(now - Jumanji.Scheduler.pruned > REQUEST_TAG_TIMEOUT * G_USEC_PER_SEC)
+  {
+    forget_request_tags(NULL, now - REQUEST_TAG_TIMEOUT * G_USEC_PER_SEC);
+    Jumanji.Scheduler.pruned = now;
+  }
+
+  /* only http requests are queued on the session */
+  if(soup_uri->scheme == SOUP_URI_SCHEME_HTTP || soup_uri->scheme == SOUP_URI_SCHEME_HTTPS)
+  {
+    SoupURI* document_uri = document ? soup_uri_new(document) : NULL;
+
+    RequestTag* tag = g_new0(RequestTag, 1);
+    tag->wv         = wv;
+    tag->document   = document_uri ? get_request_key(document_uri) : NULL;
+    tag->time       = now;
+
+    if(document_uri)
+      soup_uri_free(document_uri);
+
+    gchar* key  = get_request_key(soup_uri);
+    GList* tags = g_hash_table_lookup(Jumanji.Scheduler.tags, key);
+
+    g_hash_table_replace(Jumanji.Scheduler.tags, key, g_list_append(tags, tag));
+  }
+
+  soup_uri_free(soup_uri);
+}
+
+WebKitWebView*
+take_request_tag(SoupMessage* message)
+{
+  gchar* key  = get_request_key(soup_message_get_uri(message));
+  GList* tags = g_hash_table_lookup(Jumanji.Scheduler.tags, key);
+  gint64 now  = g_get_monotonic_time();
+
+  /* the page whose loader queued the message is its first party */
+  SoupURI* first_party = soup_message_get_first_party(message);
+  gchar*   document    = first_party ? get_request_key(first_party) : NULL;
+
+  /* when several tabs request the same uri, like a shared script or font,
+   * the oldest tag of the tab showing the first party wins, otherwise the
+   * oldest tag, tags of requests which never reached the session expire */
+  GList* match = NULL;
+  for(GList* list = tags; list;)
+  {
+    GList*      next = g_list_next(list);
+    RequestTag* tag  = (RequestTag*) list->data;
+
+    if(now - tag->time >= REQUEST_TAG_TIMEOUT * G_USEC_PER_SEC)
+    {
+      free_request_tag(tag);
+      tags = g_list_delete_link(tags, list);
+    }
+    else if(!match || (document && !g_strcmp0(tag->document, document) &&
+          g_strcmp0(((RequestTag*) match->data)->document, document)))
+      match = list;
+
+    list = next;
+  }
+
+  g_free(document);
+
+  WebKitWebView* wv = NULL;
+  if(match)
+  {
+    wv = ((RequestTag*) match->data)->wv;
+    free_request_tag(match->data);
+    tags = g_list_delete_link(tags, match);
+  }
+
+  if(tags)
+    g_hash_table_replace(Jumanji.Scheduler.tags, key, tags);
+  else
+  {
+    g_hash_table_remove(Jumanji.Scheduler.tags, key);
+    g_free(key);
+  }
+
+  return wv;
+}
+
+void
+free_request_tag(RequestTag* tag)
+{
+  g_free(tag->document);
+  g_free(tag);
+}
+
+void
+forget_request_tags(WebKitWebView* wv, gint64 before)
+{
+  GHashTableIter iter;
+  gpointer       key, value;
+
+  /* drop the tags of a destroyed view and the ones older than before */
+  g_hash_table_iter_init(&iter, Jumanji.Scheduler.tags);
+  while(g_hash_table_iter_next(&iter, &key, &value))
+  {
+    GList* tags = (GList*) value;
+
+    for(GList* list = tags; list;)
+    {
+      GList*      next = g_list_next(list);
+      RequestTag* tag  = (RequestTag*) list->data;
+
+      if((wv && tag->wv == wv) || tag->time < before)
+      {
+        free_request_tag(tag);
+        tags = g_list_delete_link(tags, list);
+      }
+
+      list = next;
+    }
+
+    if(tags)
+      g_hash_table_iter_replace(&iter, tags);
+    else
+      g_hash_table_iter_remove(&iter);
+  }
+}
+
+void
+append_json_string(GString* string, const char* value)
+{
+  g_string_append_c(string, '"');
+
+  for(const char* c = value ? value : ""; *c; c++)
+  {
+    if(*c == '"' || *c == '\\')
+      g_string_append_printf(string, "\\%c", *c);
+    else if((unsigned char) *c < 0x20)
+      g_string_append_printf(string, "\\u%04x", (unsigned char) *c);
+    else
+      g_string_append_c(string, *c);
+  }
+
+  g_string_append_c(string, '"');
+}
+
+gboolean
+export_load_timeline(WebKitWebView* wv, const char* filename)
+{
+  LoadTimeline* timeline = get_load_timeline(wv);
+  GString*      content  = g_string_new("{\"log\": {\"version\": \"1.2\", \"creator\": {\"name\": \"jumanji\", \"version\": \"0.0.0\"},\n");
+
+  /* the page */
+  GTimeVal page_time = { timeline->page_start / G_USEC_PER_SEC, timeline->page_start % G_USEC_PER_SEC };
+  gchar*   page_date = g_time_val_to_iso8601(&page_time);
+
+  g_string_append(content, "\"pages\": [{\"id\": \"page_1\", \"startedDateTime\": ");
+  append_json_string(content, page_date);
+  g_string_append(content, ", \"title\": ");
+  append_json_string(content, webkit_web_view_get_title(wv));
+  g_string_append(content, "}],\n\"entries\": [");
+  g_free(page_date);
+
+  /* the requests of the page in the order they were finished */
+  gboolean first = TRUE;
+
+  for(int i = 0; i < timeline->count; i++)
+  {
+    LoadEntry* entry = &timeline->entries[(timeline->next - timeline->count + i + LOAD_TIMELINE_SIZE) % LOAD_TIMELINE_SIZE];
+    if(entry->started < timeline->page_start)
+      continue;
+
+    gint64 dns     = (entry->dns_end && entry->dns_start) ? entry->dns_end - entry->dns_start : -1;
+    gint64 connect = (entry->connect_end && entry->connect_start) ? MAX(entry->connect_end, entry->tls_end) - entry->connect_start : -1;
+    gint64 tls     = (entry->tls_end && entry->tls_start) ? entry->tls_end - entry->tls_start : -1;
+    gint64 sent    = entry->sent ? entry->sent : entry->queued;
+    gint64 send    = entry->wrote ? entry->wrote - sent : 0;
+    gint64 blocked = MAX(sent - entry->queued - MAX(dns, 0) - MAX(connect, 0), 0);
+    gint64 wait    = entry->first_byte ? entry->first_byte - sent - send : -1;
+    gint64 receive = entry->first_byte ? entry->complete - entry->first_byte : -1;
+
+    GTimeVal started = { entry->started / G_USEC_PER_SEC, entry->started % G_USEC_PER_SEC };
+    gchar*   date    = g_time_val_to_iso8601(&started);
+
+    g_string_append(content, first ? "\n" : ",\n");
+    g_string_append(content, "{\"pageref\": \"page_1\", \"startedDateTime\": ");
+    append_json_string(content, date);
+    g_string_append_printf(content, ", \"time\": %.3f, \"request\": {\"method\": ", (entry->complete - entry->queued) / 1000.0);
+    append_json_string(content, entry->method);
+    g_string_append(content, ", \"url\": ");
+    append_json_string(content, entry->uri);
+    g_string_append_printf(content, "}, \"response\": {\"status\": %u, \"bodySize\": %ld}, \"cache\": {\"hit\": %s}, "
+        "\"timings\": {\"blocked\": %.3f, \"dns\": %.3f, \"connect\": %.3f, \"ssl\": %.3f, \"send\": %.3f, \"wait\": %.3f, \"receive\": %.3f}}",
+        entry->status, (long) entry->bytes, entry->cache_hit ? "true" : "false",
+        blocked / 1000.0, dns < 0 ? -1.0 : dns / 1000.0, connect < 0 ? -1.0 : connect / 1000.0,
+        tls < 0 ? -1.0 : tls / 1000.0, send / 1000.0, wait < 0 ? -1.0 : wait / 1000.0, receive < 0 ? -1.0 : receive / 1000.0);
+
+    g_free(date);
+    first = FALSE;
+  }
+
+  g_string_append(content, "\n]}}\n");
+
+  gboolean written = g_file_set_contents(filename, content->str, -1, NULL);
+  g_string_free(content, TRUE);
+
+  return written;
+}
+
+gint
+compare_load_entries(gconstpointer a, gconstpointer b)
+{
+  const LoadEntry* first  = *(const LoadEntry**) a;
+  const LoadEntry* second = *(const LoadEntry**) b;
+
+  return (first->started > second->started) - (first->started < second->started);
+}
+
+void
+show_load_waterfall(WebKitWebView* wv)
+{
+  LoadTimeline* timeline = get_load_timeline(wv);
+  GPtrArray*    entries  = g_ptr_array_new();
+  gint64        end      = 0;
+
+  /* the requests of the current page in the order they were started */
+  for(int i = 0; i < timeline->count; i++)
+  {
+    LoadEntry* entry = &timeline->entries[i];
+    if(entry->started < timeline->page_start)
+      continue;
+
+    g_ptr_array_add(entries, entry);
+    end = MAX(end, entry->started - timeline->page_start + entry->complete - entry->queued);
+  }
+
+  g_ptr_array_sort(entries, compare_load_entries);
+
+  gchar*   page    = g_markup_escape_text(webkit_web_view_get_uri(wv) ? webkit_web_view_get_uri(wv) : "", -1);
+  GString* content = g_string_new(NULL);
+
+  g_string_append_printf(content, "<html><head><title>Load timeline</title><style>"
+      "body { font: 12px monospace; } td { white-space: nowrap; padding: 0 4px; }"
+      "td.bar { position: relative; width: 400px; height: 14px; }"
+      "td.bar div { position: absolute; top: 2px; height: 10px; background: #6a9fd4; }"
+      "</style></head><body><h3>%s</h3><table>"
+      "<tr><th>start</th><th>time</th><th>status</th><th>size</th><th></th><th>uri</th></tr>", page);
+  g_free(page);
+
+  /* every bar starts at its offset from the start of the page */
+  for(unsigned int i = 0; i < entries->len; i++)
+  {
+    LoadEntry* entry    = g_ptr_array_index(entries, i);
+    gint64     offset   = entry->started - timeline->page_start;
+    gint64     duration = entry->complete - entry->queued;
+    gchar*     uri      = g_markup_escape_text(entry->uri ? entry->uri : "", -1);
+
+    g_string_append_printf(content, "<tr><td>%ld ms</td><td>%ld ms</td><td>%u</td><td>%ld KB</td>"
+        "<td class=\"bar\"><div style=\"left: %.1f%%; width: %.1f%%\"></div></td><td>%s</td></tr>",
+        (long) (offset / 1000), (long) (duration / 1000), entry->status, (long) (entry->bytes / 1024),
+        end ? offset * 100.0 / end : 0.0, end ? MAX(duration * 100.0 / end, 0.5) : 100.0, uri);
+    g_free(uri);
+  }
+
+  g_string_append(content, "</table></body></html>");
+
+  /* a single tab shows the waterfall, its page is neither opened with
+   * open_uri() nor added to the history */
+  if(!Jumanji.Global.waterfall)
+    Jumanji.Global.waterfall = WEBKIT_WEB_VIEW(create_blank_tab(FALSE));
+  else
+    gtk_notebook_set_current_page(Jumanji.UI.view,
+        gtk_notebook_page_num(Jumanji.UI.view, gtk_widget_get_parent(GTK_WIDGET(Jumanji.Global.waterfall))));
+
+  if(Jumanji.Global.waterfall)
+  {
+    Jumanji.Global.waterfall_source = wv;
+    webkit_web_view_load_string(Jumanji.Global.waterfall, content->str, "text/html", "UTF-8", "about:blank");
+  }
+
+  g_ptr_array_free(entries, TRUE);
+  g_string_free(content, TRUE);
+}
+
+void
+free_load_timeline(gpointer data)
+{
+  LoadTimeline* timeline = (LoadTimeline*) data;
+
+  for(int i = 0; i < LOAD_TIMELINE_SIZE; i++)
+  {
+    g_free(timeline->entries[i].uri);
+    g_free(timeline->entries[i].method);
+  }
+
+  g_free(timeline);
+}
+
+LoadTimeline*
+get_load_timeline(WebKitWebView* wv)
+{
+  LoadTimeline* timeline = g_object_get_data(G_OBJECT(wv), "load_timeline");
+
+  if(!timeline)
+  {
+    timeline = g_new0(LoadTimeline, 1);
+    g_object_set_data_full(G_OBJECT(wv), "load_timeline", timeline, free_load_timeline);
+  }
+
+  return timeline;
+}
+
+GList*
+copy_addresses(GList* addresses)
+{
+  GList* copy = NULL;
+
+  for(GList* list = addresses; list; list = g_list_next(list))
+    copy = g_list_prepend(copy, g_object_ref(list->data));
+
+  return g_list_reverse(copy);
+}
+
+void
+free_dns_entry(gpointer data)
+{
+  DNSEntry* entry = (DNSEntry*) data;
+
+  g_resolver_free_addresses(entry->addresses);
+  free(entry);
+}
+
+G_LOCK_DEFINE_STATIC(dns_cache);
+
+gboolean
+lookup_dns_cache(const char* host, GList** addresses)
+{
+  /* a ttl of 0 disables the cache, entries loaded from disk included */
+  if(dns_cache_ttl <= 0)
+    return FALSE;
+
+  G_LOCK(dns_cache);
+
+  DNSEntry* entry = g_hash_table_lookup(Jumanji.DNS.cache, host);
+  gboolean  found = entry && entry->expires > time(NULL);
+
+  if(found)
+    *addresses = copy_addresses(entry->addresses);
+
+  /* counters for :dnsstats */
+  if(found && entry->addresses)
+    Jumanji.DNS.hits++;
+  else if(found)
+    Jumanji.DNS.negative_hits++;
+  else if(entry)
+    Jumanji.DNS.expired++;
+  else
+    Jumanji.DNS.misses++;
+
+  G_UNLOCK(dns_cache);
+
+  return found;
+}
+
+void
+store_dns_entry(const char* host, GList* addresses, GError* error)
+{
+  /* temporary failures and cancelled lookups are not cached */
+  if(!addresses && !g_error_matches(error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND))
+    return;
+
+  int ttl = addresses ? dns_cache_ttl : MIN(dns_cache_ttl, DNS_NEGATIVE_TTL);
+  if(ttl <= 0)
+    return;
+
+  DNSEntry* entry = malloc(sizeof(DNSEntry));
+  if(!entry)
+    out_of_memory();
+
+  entry->addresses = copy_addresses(addresses);
+  entry->expires   = time(NULL) + ttl;
+
+  G_LOCK(dns_cache);
+  g_hash_table_replace(Jumanji.DNS.cache, g_strdup(host), entry);
+  G_UNLOCK(dns_cache);
+}
+
+void
+resolver_class_init(gpointer klass, gpointer UNUSED(data))
+{
+  GResolverClass* resolver_class = G_RESOLVER_CLASS(klass);
+
+  Jumanji.DNS.parent = g_type_class_peek_parent(klass);
+
+  resolver_class->lookup_by_name        = resolver_lookup_by_name;
+  resolver_class->lookup_by_name_async  = resolver_lookup_by_name_async;
+  resolver_class->lookup_by_name_finish = resolver_lookup_by_name_finish;
+}
+
+GList*
+resolver_lookup_by_name(GResolver* resolver, const gchar* hostname, GCancellable* cancellable, GError** error)
+{
+  GList* addresses = NULL;
+
+  if(lookup_dns_cache(hostname, &addresses))
+  {
+    if(!addresses)
+      g_set_error(error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND, "Could not resolve %s", hostname);
+
+    return addresses;
+  }
+
+  GError* lookup_error = NULL;
+  addresses = Jumanji.DNS.parent->lookup_by_name(resolver, hostname, cancellable, &lookup_error);
+
+  store_dns_entry(hostname, addresses, lookup_error);
+
+  if(lookup_error)
+    g_propagate_error(error, lookup_error);
+
+  return addresses;
+}
+
+void
+resolver_lookup_by_name_async(GResolver* resolver, const gchar* hostname, GCancellable* cancellable,
+    GAsyncReadyCallback callback, gpointer data)
+{
+  GTask* task      = g_task_new(resolver, cancellable, callback, data);
+  GList* addresses = NULL;
+
+  if(lookup_dns_cache(hostname, &addresses))
+  {
+    if(addresses)
+      g_task_return_pointer(task, addresses, (GDestroyNotify) g_resolver_free_addresses);
+    else
+      g_task_return_new_error(task, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND, "Could not resolve %s", hostname);
+
+    g_object_unref(task);
+    return;
+  }
+
+  g_task_set_task_data(task, g_strdup(hostname), g_free);
+  Jumanji.DNS.parent->lookup_by_name_async(resolver, hostname, cancellable, cb_resolver_lookup_done, task);
+}
+
+GList*
+resolver_lookup_by_name_finish(GResolver* UNUSED(resolver), GAsyncResult* result, GError** error)
+{
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+gboolean
+prefetch_uri(const char* uri)
+{
+  if(!uri)
+    return FALSE;
+
+  /* bookmarks may carry tags after the uri */
+  gchar*   location = g_strndup(uri, strcspn(uri, " "));
+  SoupURI* soup_uri = soup_uri_new(location);
+  g_free(location);
+
+  if(!soup_uri)
+    return FALSE;
+
+  if((soup_uri->scheme != SOUP_URI_SCHEME_HTTP && soup_uri->scheme != SOUP_URI_SCHEME_HTTPS) || !soup_uri->host)
+  {
+    soup_uri_free(soup_uri);
+    return FALSE;
+  }
+
+  if(dns_prefetch)
+    prefetch_host(soup_uri->host);
+
+  soup_uri_free(soup_uri);
+
+  return TRUE;
+}
+
+gboolean
+remove_prefetched_host(gpointer UNUSED(key), gpointer value, gpointer data)
+{
+  return *((gint64*) data) - *((gint64*) value) > PREFETCH_TTL * G_USEC_PER_SEC;
+}
+
+void
+prefetch_host(const char* host)
+{
+  gint64  now     = g_get_monotonic_time();
+  gint64* fetched = g_hash_table_lookup(Jumanji.Prefetch.hosts, host);
+
+  /* skip warm hosts, a host which has never been prefetched has no entry */
+  if(fetched && now - *fetched <= PREFETCH_TTL * G_USEC_PER_SEC)
+    return;
+
+  /* limit the rate of lookups, the latest host waits for the next slot */
+  gint64 wait = PREFETCH_INTERVAL * 1000 - (now - Jumanji.Prefetch.last);
+  if(Jumanji.Prefetch.last && wait > 0)
+  {
+    g_free(Jumanji.Prefetch.pending);
+    Jumanji.Prefetch.pending = g_strdup(host);
+
+    if(!Jumanji.Prefetch.source)
+      Jumanji.Prefetch.source = g_timeout_add(wait / 1000 + 1, cb_prefetch_timeout, NULL);
+
+    return;
+  }
+
+  soup_session_prefetch_dns(Jumanji.Soup.session, host, NULL, NULL, NULL);
+  Jumanji.Prefetch.last = now;
+
+  /* hosts which went cold are of no use any more */
+  g_hash_table_foreach_remove(Jumanji.Prefetch.hosts, remove_prefetched_host, &now);
+
+  gint64* time = g_new(gint64, 1);
+  *time        = now;
+  g_hash_table_replace(Jumanji.Prefetch.hosts, g_strdup(host), time);
+}
+
+void
+prerender_uri(const char* uri)
+{
+  if(!prerender || !uri || !strstr(uri, "://"))
+    return;
+
+  gchar* location = g_strdup(uri);
+  gchar* new_uri  = expand_uri(location);
+  g_free(location);
+
+  if(!new_uri || (Jumanji.Prerender.uri && !strcmp(new_uri, Jumanji.Prerender.uri)))
+  {
+    g_free(new_uri);
+    return;
+  }
+
+  /* only the latest prediction is kept */
+  discard_prerender();
+
+  GtkWidget* wv = create_web_view();
+  if(!wv)
+  {
+    g_free(new_uri);
+    return;
+  }
+
+  /* lay the page out with the size of the visible tab */
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(GTK_WIDGET(GET_CURRENT_TAB_WIDGET()), &allocation);
+
+  Jumanji.Prerender.window = gtk_offscreen_window_new();
+  gtk_window_set_default_size(GTK_WINDOW(Jumanji.Prerender.window), allocation.width, allocation.height);
+  gtk_container_add(GTK_CONTAINER(Jumanji.Prerender.window), wv);
+  gtk_widget_show_all(Jumanji.Prerender.window);
+
+  Jumanji.Prerender.view   = WEBKIT_WEB_VIEW(wv);
+  Jumanji.Prerender.uri    = new_uri;
+  Jumanji.Prerender.source = g_timeout_add_seconds(MAX(prerender_timeout, 1), cb_prerender_timeout, NULL);
+
+  webkit_web_view_load_uri(Jumanji.Prerender.view, new_uri);
+}
+
+gboolean
+swap_prerendered(WebKitWebView* wv, const char* uri)
+{
+  if(!Jumanji.Prerender.view || strcmp(uri, Jumanji.Prerender.uri))
+    return FALSE;
+
+  GtkWidget*     tab  = gtk_widget_get_parent(GTK_WIDGET(wv));
+  WebKitWebView* view = Jumanji.Prerender.view;
+
+  if(!tab || gtk_notebook_page_num(Jumanji.UI.view, tab) == -1)
+    return FALSE;
+
+  /* the history and the :setlocal settings of a view can not be moved to
+   * another one, only a new tab without a document may take the
+   * prerendered page, navigating inside of a tab loads the page again */
+  if(webkit_web_view_get_uri(wv) || g_object_get_data(G_OBJECT(wv), "local_overrides"))
+    return FALSE;
+
+  webkit_web_view_set_zoom_level(view, webkit_web_view_get_zoom_level(wv));
+
+  /* forget the state of the replaced view */
+  WebKitWebFrame* frame = webkit_web_view_get_main_frame(wv);
+  if(frame)
+    clear_script_functions(wv, webkit_web_frame_get_global_context(frame));
+
+  g_hash_table_remove(Jumanji.Scheduler.tabs, wv);
+  forget_request_tags(wv, 0);
+
+  /* the replaced view may still run the script which opened the uri */
+  g_object_ref(wv);
+  gtk_container_remove(GTK_CONTAINER(tab), GTK_WIDGET(wv));
+  g_idle_add(cb_release_web_view, wv);
+
+  g_object_ref(view);
+  gtk_container_remove(GTK_CONTAINER(Jumanji.Prerender.window), GTK_WIDGET(view));
+  gtk_container_add(GTK_CONTAINER(tab), GTK_WIDGET(view));
+  gtk_widget_show(GTK_WIDGET(view));
+  g_object_unref(view);
+
+  Jumanji.Prerender.view = NULL;
+  discard_prerender();
+
+  /* the prerendered requests belong to this tab now */
+  if(Jumanji.Scheduler.focused == wv)
+  {
+    Jumanji.Scheduler.focused = view;
+    set_request_priority(view, SOUP_MESSAGE_PRIORITY_HIGH);
+    run_pending_requests(view);
+
+    gtk_widget_grab_focus(GTK_WIDGET(view));
+  }
+
+  mark_tab_dirty(tab);
+  schedule_update(UPDATE_STATUS | UPDATE_URI);
+
+  return TRUE;
+}
+
+void
+set_request_priority(WebKitWebView* wv, SoupMessagePriority priority)
+{
+  TabRequests* requests = g_hash_table_lookup(Jumanji.Scheduler.tabs, wv);
+  if(!requests)
+    return;
+
+  for(GList* list = requests->messages; list; list = g_list_next(list))
+    soup_message_set_priority(SOUP_MESSAGE(list->data), priority);
+}
+
+gboolean
+is_https_host(const char* location)
+{
+  size_t length = strcspn(location, "/:?#");
+
+  /* a non-default port says nothing about the https port of the host */
+  if(location[length] == ':' && (strncmp(location + length, ":80", 3) || !strchr("/?#", location[length + 3])))
+    return FALSE;
+
+  gchar*   host  = g_ascii_strdown(location, length);
+  time_t   now   = time(NULL);
+  gboolean known = FALSE;
+
+  /* the host itself or a parent domain with includeSubDomains */
+  for(char* name = host; name && !known; name = strchr(name, '.'))
+  {
+    if(name[0] == '.')
+      name++;
+
+    HTTPSHost* entry = g_hash_table_lookup(Jumanji.Global.https_hosts, name);
+    if(!entry)
+      continue;
+
+    /* expired entries go away, removed ones stay until they are written */
+    if(entry->expires && entry->expires <= now)
+      g_hash_table_remove(Jumanji.Global.https_hosts, name);
+    else if(entry->expires && (name == host || entry->subdomains))
+      known = TRUE;
+  }
+
+  g_free(host);
+
+  return known;
+}
+
+void
+set_https_host(const char* host, time_t expires, gboolean subdomains)
+{
+  HTTPSHost* entry  = g_new0(HTTPSHost, 1);
+  entry->expires    = expires;
+  entry->subdomains = subdomains;
+
+  g_hash_table_replace(Jumanji.Global.https_hosts, g_strdup(host), entry);
+}
+
+void
+load_https_hosts(const char* filename)
+{
+  char* content = NULL;
+
+  if(!g_file_get_contents(filename, &content, NULL, NULL))
+    return;
+
+  /* host, expiry, includeSubDomains; entries already known are kept */
+  gchar** lines = g_strsplit(content, "\n", -1);
+  time_t  now   = time(NULL);
+
+  for(int i = 0; lines[i]; i++)
+  {
+    gchar** fields = g_strsplit(lines[i], "\t", -1);
+
+    if(g_strv_length(fields) == 3 && !g_hash_table_lookup(Jumanji.Global.https_hosts, fields[0]))
+    {
+      time_t expires = strtoul(fields[1], NULL, 10);
+
+      if(expires > now)
+        set_https_host(fields[0], expires, !strcmp(fields[2], "1"));
+    }
+    /* files of older versions only list the hosts */
+    else if(g_strv_length(fields) == 1 && strlen(fields[0]) && !g_hash_table_lookup(Jumanji.Global.https_hosts, fields[0]))
+      set_https_host(fields[0], now + HTTPS_REDIRECT_TTL, FALSE);
+
+    g_strfreev(fields);
+  }
+
+  g_strfreev(lines);
+  g_free(content);
+}
+
+void
+save_dns_cache()
+{
+  /* failed lookups are not kept */
+  GString*       dns_list = g_string_new("");
+  GHashTableIter iter;
+  gpointer       host, entry;
+  time_t         now = time(NULL);
+
+  G_LOCK(dns_cache);
+
+  g_hash_table_iter_init(&iter, Jumanji.DNS.cache);
+  while(g_hash_table_iter_next(&iter, &host, &entry))
+  {
+    DNSEntry* dns_entry = (DNSEntry*) entry;
+
+    if(!dns_entry->addresses || dns_entry->expires <= now)
+      continue;
+
+    g_string_append_printf(dns_list, "%s %lu", (char*) host, (unsigned long) dns_entry->expires);
+
+    for(GList* list = dns_entry->addresses; list; list = g_list_next(list))
+    {
+      gchar* address = g_inet_address_to_string(G_INET_ADDRESS(list->data));
+      g_string_append_printf(dns_list, " %s", address);
+      g_free(address);
+    }
+
+    g_string_append(dns_list, "\n");
+  }
+
+  G_UNLOCK(dns_cache);
+
+  char* dns_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_DNS, NULL);
+  g_file_set_contents(dns_file, dns_list->str, -1, NULL);
+
+  g_free(dns_file);
+  g_string_free(dns_list, TRUE);
+}
+
+void
+save_https_hosts()
+{
+  char* https_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_HTTPS, NULL);
+  int   lock       = lock_file(https_file);
+
+  /* other jumanji instances write the same file, merge their hosts */
+  load_https_hosts(https_file);
+
+  GString*       https_list = g_string_new("");
+  GHashTableIter iter;
+  gpointer       host, value;
+  time_t         now = time(NULL);
+
+  g_hash_table_iter_init(&iter, Jumanji.Global.https_hosts);
+  while(g_hash_table_iter_next(&iter, &host, &value))
+  {
+    HTTPSHost* entry = (HTTPSHost*) value;
+
+    /* hosts removed by a max-age of 0 are dropped from the file as well */
+    if(entry->expires <= now)
+      g_hash_table_iter_remove(&iter);
+    else
+      g_string_append_printf(https_list, "%s\t%lu\t%d\n", (char*) host, (unsigned long) entry->expires, entry->subdomains ? 1 : 0);
+  }
+
+  g_file_set_contents(https_file, https_list->str, -1, NULL);
+  unlock_file(lock);
+
+  g_free(https_file);
+  g_string_free(https_list, TRUE);
+}
+
+gboolean
+match_block_host(GHashTable* hosts, const char* host, size_t host_length)
+{
+  if(!g_hash_table_size(hosts))
+    return FALSE;
+
+  gchar*   name  = g_strndup(host, host_length);
+  gboolean found = FALSE;
+
+  /* the host itself and all of its parent domains */
+  for(char* domain = name; domain && !found; domain = strchr(domain, '.'))
+  {
+    if(*domain == '.')
+      domain++;
+
+    found = g_hash_table_lookup(hosts, domain) != NULL;
+  }
+
+  g_free(name);
+
+  return found;
+}
+
+gboolean
+match_block_pattern(const char* pattern, const char* text, const char* text_end,
+    gboolean start_anchor, gboolean end_anchor)
+{
+  /* '*' splits the pattern into segments. Every segment is taken at its
+   * leftmost position behind the previous one, which keeps the most room
+   * for the rest, so there is no need to backtrack. */
+  for(;;)
+  {
+    size_t      length = strcspn(pattern, "*");
+    gboolean    last   = pattern[length] == '\0';
+    const char* end    = NULL;
+
+    for(const char* start = text; start <= text_end && !end; start++)
+    {
+      end = match_block_segment(pattern, length, start, text_end);
+
+      /* the last segment of an end anchored pattern has to reach the end */
+      if(end && last && end_anchor && end != text_end)
+        end = NULL;
+
+      /* the first segment of a start anchored pattern only matches in place */
+      if(start_anchor)
+        break;
+    }
+
+    if(!end)
+      return FALSE;
+    if(last)
+      return TRUE;
+
+    text          = end;
+    pattern      += length + 1;
+    start_anchor  = FALSE;
+  }
+}
+
+const char*
+match_block_segment(const char* segment, size_t length, const char* text, const char* text_end)
+{
+  /* '^' matches a separator or the end of the uri */
+  for(size_t i = 0; i < length; i++)
+  {
+    if(segment[i] == '^' && text == text_end && !*text_end)
+      continue;
+
+    if(text == text_end)
+      return NULL;
+
+    if(segment[i] == '^')
+    {
+      if(g_ascii_isalnum(*text) || strchr("_-.%", *text))
+        return NULL;
+    }
+    else if(segment[i] != *text)
+      return NULL;
+
+    text++;
+  }
+
+  return text;
+}
+
+gboolean
+match_block_rules(const char* uri, const char* host, size_t host_length, gboolean exception)
+{
+  const char* uri_end = uri + strlen(uri);
+  int         state   = 0;
+
+  for(const char* p = uri; *p; p++)
+  {
+    int next;
+    while((next = get_block_node_child(state, *p)) == -1 && state != 0)
+      state = BLOCK_NODE(state).fail;
+
+    state = (next != -1) ? next : 0;
+
+    /* verify every rule whose keyword ends here: the part behind the
+     * keyword has to follow it, the part in front of it has to end where
+     * the keyword starts */
+    int node = (BLOCK_NODE(state).output != -1) ? state : BLOCK_NODE(state).dict;
+    for(; node != -1; node = BLOCK_NODE(node).dict)
+    {
+      for(int r = BLOCK_NODE(node).output; r != -1; r = BLOCK_RULE(r).next)
+      {
+        BlockRule*  rule    = &BLOCK_RULE(r);
+        const char* keyword = p + 1 - rule->keyword_length;
+
+        if(rule->exception != exception)
+          continue;
+
+        if(!match_block_pattern(rule->suffix, p + 1, uri_end, TRUE, rule->end_anchor))
+          continue;
+
+        if(rule->host_anchor)
+        {
+          /* the pattern has to start at a label of the host */
+          for(const char* label = host; label && label <= keyword && label < host + host_length; label = strchr(label, '.'))
+          {
+            if(*label == '.')
+              label++;
+
+            if(label <= keyword && match_block_pattern(rule->prefix, label, keyword, TRUE, TRUE))
+              return TRUE;
+          }
+        }
+        else if(match_block_pattern(rule->prefix, uri, keyword, rule->start_anchor, TRUE))
+          return TRUE;
+      }
+    }
+  }
+
+  return FALSE;
+}
+
+int
+get_tab_width()
+{
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(Jumanji.UI.tabbar, &allocation);
+
+  /* share the tabbar between all tabs, but keep tabs readable and scroll
+   * the tabbar if they do not fit anymore */
+  int number_of_tabs = gtk_notebook_get_n_pages(Jumanji.UI.view);
+  int width          = number_of_tabs ? allocation.width / number_of_tabs : allocation.width;
+
+  if(width < tabbar_min_width)
+    width = MIN(tabbar_min_width, allocation.width);
+
+  return MAX(width, 1);
+}
+
+void
+init_data()
+{
+  /* read bookmarks */
+  char* bookmark_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_BOOKMARKS, NULL);
+
+  if(!bookmark_file)
+    return;
+
+  if(g_file_test(bookmark_file, G_FILE_TEST_IS_REGULAR))
+  {
+    char* content = NULL;
+
+    if(g_file_get_contents(bookmark_file, &content, NULL, NULL))
+    {
+      gchar **lines = g_strsplit(content, "\n", -1);
+      int     n     = g_strv_length(lines) - 1;
+
+      int i;
+      for(i = 0; i < n; i++)
+      {
+        if(!strlen(lines[i]))
+          continue;
+
+        Jumanji.Global.bookmarks = g_list_append(Jumanji.Global.bookmarks, lines[i]);
+      }
 
       g_free(content);
       g_free(lines);
@@ -795,6 +2576,79 @@ init_data()
 
   g_free(history_file);
 
+  /* read https hosts */
+  char* https_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_HTTPS, NULL);
+  load_https_hosts(https_file);
+  g_free(https_file);
+
+  /* read dns cache */
+  char* dns_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_DNS, NULL);
+
+  if(dns_cache_ttl > 0 && g_file_test(dns_file, G_FILE_TEST_IS_REGULAR))
+  {
+    char* content = NULL;
+
+    if(g_file_get_contents(dns_file, &content, NULL, NULL))
+    {
+      gchar **lines = g_strsplit(content, "\n", -1);
+      time_t  now   = time(NULL);
+
+      /* host, expiration time, addresses */
+      for(int i = 0; lines[i]; i++)
+      {
+        gchar **fields = g_strsplit(lines[i], " ", -1);
+        int     n      = g_strv_length(fields);
+        time_t  expires = (n > 2) ? (time_t) strtoul(fields[1], NULL, 10) : 0;
+
+        if(expires > now)
+        {
+          DNSEntry* entry = malloc(sizeof(DNSEntry));
+          if(!entry)
+            out_of_memory();
+
+          entry->addresses = NULL;
+          entry->expires   = expires;
+
+          for(int j = n - 1; j > 1; j--)
+          {
+            GInetAddress* address = g_inet_address_new_from_string(fields[j]);
+            if(address)
+              entry->addresses = g_list_prepend(entry->addresses, address);
+          }
+
+          g_hash_table_replace(Jumanji.DNS.cache, g_strdup(fields[0]), entry);
+        }
+
+        g_strfreev(fields);
+      }
+
+      g_strfreev(lines);
+      g_free(content);
+    }
+  }
+
+  g_free(dns_file);
+
+  /* resolve the most recent hosts of the history in advance */
+  GHashTable* warm_hosts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+  for(GList* h = Jumanji.Global.history; h && g_hash_table_size(warm_hosts) < DNS_WARM_HOSTS; h = g_list_next(h))
+  {
+    SoupURI* uri = soup_uri_new((char*) h->data);
+    if(!uri)
+      continue;
+
+    if(uri->host && !g_hash_table_lookup(warm_hosts, uri->host))
+    {
+      g_hash_table_insert(warm_hosts, g_strdup(uri->host), GINT_TO_POINTER(1));
+      soup_session_prefetch_dns(Jumanji.Soup.session, uri->host, NULL, NULL, NULL);
+    }
+
+    soup_uri_free(uri);
+  }
+
+  g_hash_table_destroy(warm_hosts);
+
   /* read sessions */
   gchar* sessions_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_SESSIONS, NULL);
 
@@ -830,11 +2684,39 @@ init_data()
   g_free(sessions_file);
 
   /* load cookies */
-  char* cookie_file        = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_COOKIES, NULL);
-  SoupCookieJar *cookiejar = soup_cookie_jar_text_new(cookie_file, FALSE);
+  Jumanji.Soup.cookie_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_COOKIES, NULL);
+  Jumanji.Soup.cookiejar   = soup_cookie_jar_new();
+
+  load_cookies(Jumanji.Soup.cookie_file);
+
+  g_signal_connect(G_OBJECT(Jumanji.Soup.cookiejar), "changed", G_CALLBACK(cb_cookie_changed), NULL);
+  soup_session_add_feature(Jumanji.Soup.session, (SoupSessionFeature*) Jumanji.Soup.cookiejar);
+
+  /* load content blocker rules */
+  char* adblock_file = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_ADBLOCK, NULL);
+
+  if(g_file_test(adblock_file, G_FILE_TEST_IS_REGULAR))
+  {
+    char* content = NULL;
+
+    if(g_file_get_contents(adblock_file, &content, NULL, NULL))
+    {
+      gchar **lines = g_strsplit(content, "\n", -1);
+
+      for(int i = 0; lines[i]; i++)
+        add_block_rule(g_strstrip(lines[i]));
 
-  soup_session_add_feature(Jumanji.Soup.session, (SoupSessionFeature*) cookiejar);
-  g_free(cookie_file);
+      compile_block_rules();
+
+      g_strfreev(lines);
+      g_free(content);
+    }
+  }
+
+  g_free(adblock_file);
+
+  /* load disk cache */
+  update_disk_cache();
 }
 
 void
@@ -921,22 +2803,27 @@ init_settings()
   gdk_color_parse(notification_w_bgcolor, &(Jumanji.Style.notification_w_bg));
   Jumanji.Style.font = pango_font_description_from_string(font);
 
-  /* statusbar */
-  gtk_widget_modify_bg(GTK_WIDGET(Jumanji.UI.statusbar),       GTK_STATE_NORMAL, &(Jumanji.Style.statusbar_ssl_bg));
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.text),     GTK_STATE_NORMAL, &(Jumanji.Style.statusbar_ssl_fg));
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.buffer),   GTK_STATE_NORMAL, &(Jumanji.Style.statusbar_ssl_fg));
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.tabs),     GTK_STATE_NORMAL, &(Jumanji.Style.statusbar_ssl_fg));
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.position), GTK_STATE_NORMAL, &(Jumanji.Style.statusbar_ssl_fg));
+  /* precompute styles */
+  Jumanji.Style.statusbar_style      = create_rc_style(&(Jumanji.Style.statusbar_fg),     &(Jumanji.Style.statusbar_bg),     NULL, NULL);
+  Jumanji.Style.statusbar_ssl_style  = create_rc_style(&(Jumanji.Style.statusbar_ssl_fg), &(Jumanji.Style.statusbar_ssl_bg), NULL, NULL);
+  Jumanji.Style.inputbar_style       = create_rc_style(NULL, NULL, &(Jumanji.Style.inputbar_fg),       &(Jumanji.Style.inputbar_bg));
+  Jumanji.Style.notification_e_style = create_rc_style(NULL, NULL, &(Jumanji.Style.notification_e_fg), &(Jumanji.Style.notification_e_bg));
+  Jumanji.Style.notification_w_style = create_rc_style(NULL, NULL, &(Jumanji.Style.notification_w_fg), &(Jumanji.Style.notification_w_bg));
+
+  /* tabbar */
+  PangoLayout* layout = gtk_widget_create_pango_layout(Jumanji.UI.tabbar, "jumanji");
+  pango_layout_set_font_description(layout, Jumanji.Style.font);
 
-  gtk_widget_modify_font(GTK_WIDGET(Jumanji.Statusbar.text),     Jumanji.Style.font);
-  gtk_widget_modify_font(GTK_WIDGET(Jumanji.Statusbar.buffer),   Jumanji.Style.font);
-  gtk_widget_modify_font(GTK_WIDGET(Jumanji.Statusbar.tabs),     Jumanji.Style.font);
-  gtk_widget_modify_font(GTK_WIDGET(Jumanji.Statusbar.position), Jumanji.Style.font);
+  int tabbar_height;
+  pango_layout_get_pixel_size(layout, NULL, &tabbar_height);
+  gtk_widget_set_size_request(Jumanji.UI.tabbar, -1, tabbar_height + 4);
+  g_object_unref(layout);
+
+  /* statusbar */
+  set_statusbar_style(TRUE);
 
   /* inputbar */
-  gtk_widget_modify_base(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.inputbar_bg));
-  gtk_widget_modify_text(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.inputbar_fg));
-  gtk_widget_modify_font(GTK_WIDGET(Jumanji.UI.inputbar),                     Jumanji.Style.font);
+  set_inputbar_style(DEFAULT);
 
   /* set window size */
   gtk_window_set_default_size(GTK_WINDOW(Jumanji.UI.window), default_width, default_height);
@@ -947,35 +2834,324 @@ init_settings()
   /* apply user agent */
   if(!user_agent && browser_name)
   {
-    char* current_user_agent = NULL;
-    g_object_get(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", &current_user_agent, NULL);
+    char* current_user_agent = NULL;
+    g_object_get(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", &current_user_agent, NULL);
+
+    char* new_user_agent = g_strconcat(current_user_agent, " ", browser_name, NULL);
+    g_object_set(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", new_user_agent, NULL);
+    g_free(new_user_agent);
+  }
+  else if(user_agent)
+  {
+    g_object_set(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", user_agent, NULL);
+  }
+}
+
+JSObjectRef
+create_bridge(WebKitWebView* wv, JSContextRef context)
+{
+
+  if(!Jumanji.Global.bridge_class)
+  {
+    static const JSStaticFunction functions[] = {
+      {"openUri", cb_js_open_uri, kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete},
+      {"setMode", cb_js_set_mode, kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete},
+      {NULL,      NULL,           0}
+    };
+
+    JSClassDefinition definition = kJSClassDefinitionEmpty;
+    definition.className         = "Jumanji";
+    definition.staticFunctions   = functions;
+
+    Jumanji.Global.bridge_class = JSClassCreate(&definition);
+  }
+
+  /* a native jumanji object that knows the tab it belongs to */
+  return JSObjectMake(context, Jumanji.Global.bridge_class, wv);
+}
+
+void
+inject_bridge(WebKitWebView* wv, JSContextRef context)
+{
+  if(!context)
+    return;
+
+  /* user scripts are evaluated as global code and find the object there */
+  JSObjectRef bridge = create_bridge(wv, context);
+  JSStringRef name   = JSStringCreateWithUTF8CString("jumanji");
+
+  JSObjectSetProperty(context, JSContextGetGlobalObject(context), name, bridge,
+      kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete | kJSPropertyAttributeDontEnum, NULL);
+  JSStringRelease(name);
+}
+
+void
+inject_scripts(WebKitWebFrame* frame)
+{
+  if(!Jumanji.Global.script_bundle && !Jumanji.Global.script_index)
+    return;
+
+  /* every document of a frame gets the current script generation exactly
+   * once, the generation is reset whenever the window object is cleared */
+  if(GPOINTER_TO_INT(g_object_get_data(G_OBJECT(frame), "script_generation")) == Jumanji.Global.script_generation)
+    return;
+
+  JSContextRef context = webkit_web_frame_get_global_context(frame);
+  if(!context)
+    return;
+
+  JSValueRef exception = NULL;
+  if(Jumanji.Global.script_bundle)
+    JSEvaluateScript(context, Jumanji.Global.script_bundle, JSContextGetGlobalObject(context), NULL, 0, &exception);
+
+  /* site specific scripts */
+  GList* scripts = get_site_scripts(webkit_web_frame_get_uri(frame));
+  for(GList* list = scripts; list; list = g_list_next(list))
+    JSEvaluateScript(context, ((ScriptList*) list->data)->source, JSContextGetGlobalObject(context), NULL, 0, &exception);
+  g_list_free(scripts);
+
+  g_object_set_data(G_OBJECT(frame), "script_generation", GINT_TO_POINTER(Jumanji.Global.script_generation));
+}
+
+GList*
+get_site_scripts(const char* uri)
+{
+  if(!uri || !Jumanji.Global.script_index)
+    return NULL;
+
+  SoupURI* soup_uri = soup_uri_new(uri);
+  if(!soup_uri)
+    return NULL;
+
+  const char* path    = soup_uri->path ? soup_uri->path : "/";
+  GHashTable* matches = g_hash_table_new(g_direct_hash, g_direct_equal);
+  ScriptIndex* node   = Jumanji.Global.script_index;
+
+  /* walk the host labels from the top level domain downwards */
+  gchar*  host   = g_ascii_strdown(soup_uri->host ? soup_uri->host : "", -1);
+  gchar** labels = g_strsplit(host, ".", -1);
+  int     n      = g_strv_length(labels);
+
+  for(int i = n; node; i--)
+  {
+    for(GList* list = node->wildcard; list; list = g_list_next(list))
+    {
+      ScriptPattern* pattern = (ScriptPattern*) list->data;
+      if(g_str_has_prefix(path, pattern->path))
+        g_hash_table_insert(matches, pattern->script, pattern->script);
+    }
+
+    if(i == 0)
+    {
+      for(GList* list = node->exact; list; list = g_list_next(list))
+      {
+        ScriptPattern* pattern = (ScriptPattern*) list->data;
+        if(g_str_has_prefix(path, pattern->path))
+          g_hash_table_insert(matches, pattern->script, pattern->script);
+      }
+
+      break;
+    }
+
+    node = node->children ? g_hash_table_lookup(node->children, labels[i - 1]) : NULL;
+  }
+
+  /* keep the order in which the scripts have been loaded */
+  GList* scripts = NULL;
+  if(g_hash_table_size(matches))
+  {
+    for(ScriptList* sl = Jumanji.Global.scripts; sl; sl = sl->next)
+      if(g_hash_table_lookup(matches, sl))
+        scripts = g_list_append(scripts, sl);
+  }
+
+  g_strfreev(labels);
+  g_free(host);
+  g_hash_table_destroy(matches);
+  soup_uri_free(soup_uri);
+
+  return scripts;
+}
+
+void
+index_script(ScriptList* script, char* pattern)
+{
+  /* patterns look like [*.]host[/path], a single * matches every host */
+  char*  slash    = strchr(pattern, '/');
+  gchar* host     = slash ? g_strndup(pattern, slash - pattern) : g_strdup(pattern);
+  char*  labels   = host;
+  gboolean wildcard = FALSE;
+
+  if(!strcmp(labels, "*"))
+  {
+    labels   = "";
+    wildcard = TRUE;
+  }
+  else if(g_str_has_prefix(labels, "*."))
+  {
+    labels  += 2;
+    wildcard = TRUE;
+  }
+
+  if(!Jumanji.Global.script_index)
+    Jumanji.Global.script_index = g_new0(ScriptIndex, 1);
+
+  ScriptIndex* node = Jumanji.Global.script_index;
+  gchar** tokens    = g_strsplit(labels, ".", -1);
+
+  int n = g_strv_length(tokens);
+  for(int i = n - 1; i >= 0; i--)
+  {
+    if(!strlen(tokens[i]))
+      continue;
+
+    gchar* label = g_ascii_strdown(tokens[i], -1);
+
+    if(!node->children)
+      node->children = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) free_script_index);
+
+    ScriptIndex* child = g_hash_table_lookup(node->children, label);
+    if(!child)
+    {
+      child = g_new0(ScriptIndex, 1);
+      g_hash_table_insert(node->children, label, child);
+    }
+    else
+      g_free(label);
+
+    node = child;
+  }
+
+  ScriptPattern* entry = g_new(ScriptPattern, 1);
+  entry->script = script;
+  entry->path   = slash ? slash : "/";
+
+  if(wildcard)
+    node->wildcard = g_list_append(node->wildcard, entry);
+  else
+    node->exact    = g_list_append(node->exact, entry);
+
+  g_strfreev(tokens);
+  g_free(host);
+}
+
+void
+free_script_index(ScriptIndex* node)
+{
+  if(!node)
+    return;
+
+  if(node->children)
+    g_hash_table_destroy(node->children);
+
+  for(GList* list = node->exact; list; list = g_list_next(list))
+    g_free(list->data);
+  for(GList* list = node->wildcard; list; list = g_list_next(list))
+    g_free(list->data);
+
+  g_list_free(node->exact);
+  g_list_free(node->wildcard);
+  g_free(node);
+}
+
+void
+update_disk_cache()
+{
+  /* a size of 0 or private browsing detaches the cache, its index is
+   * written first, responses of a private session never reach the disk */
+  if(cache_size <= 0 || private_browsing)
+  {
+    if(Jumanji.Soup.cache)
+    {
+      soup_session_remove_feature(Jumanji.Soup.session, SOUP_SESSION_FEATURE(Jumanji.Soup.cache));
+      soup_cache_flush(Jumanji.Soup.cache);
+      soup_cache_dump(Jumanji.Soup.cache);
+      g_object_unref(Jumanji.Soup.cache);
+      Jumanji.Soup.cache = NULL;
+    }
 
-    char* new_user_agent = g_strconcat(current_user_agent, " ", browser_name, NULL);
-    g_object_set(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", new_user_agent, NULL);
-    g_free(new_user_agent);
+    return;
   }
-  else if(user_agent)
+
+  if(!Jumanji.Soup.cache)
   {
-    g_object_set(G_OBJECT(Jumanji.Global.browser_settings), "user-agent", user_agent, NULL);
+    char* cache_dir    = g_build_filename(g_get_home_dir(), JUMANJI_DIR, JUMANJI_CACHE, NULL);
+    Jumanji.Soup.cache = soup_cache_new(cache_dir, SOUP_CACHE_SINGLE_USER);
+
+    soup_cache_load(Jumanji.Soup.cache);
+    soup_session_add_feature(Jumanji.Soup.session, SOUP_SESSION_FEATURE(Jumanji.Soup.cache));
+    g_free(cache_dir);
   }
+
+  /* the size is given in megabyte, compute the bytes without overflow */
+  soup_cache_set_max_size(Jumanji.Soup.cache, (guint) MIN((guint64) cache_size * 1024 * 1024, G_MAXUINT));
 }
 
 void
-load_all_scripts()
+update_script_bundle()
 {
-  int ls = (size_t) g_object_get_data(G_OBJECT(GET_CURRENT_TAB()), "loaded_scripts");
+  if(Jumanji.Global.script_bundle)
+  {
+    JSStringRelease(Jumanji.Global.script_bundle);
+    Jumanji.Global.script_bundle = NULL;
+  }
+
+  free_script_index(Jumanji.Global.script_index);
+  Jumanji.Global.script_index = NULL;
+
+  /* concatenate all global scripts once, every frame evaluates the same
+   * bundle; site specific scripts are indexed by their host patterns */
+  GString* buffer = g_string_new(NULL);
 
-  if(!ls)
+  for(ScriptList* sl = Jumanji.Global.scripts; sl; sl = sl->next)
   {
-    ScriptList* sl = Jumanji.Global.scripts;
-    while(sl)
+    if(sl->source)
     {
-      run_script(sl->content, NULL, NULL);
-      sl = sl->next;
+      JSStringRelease(sl->source);
+      sl->source = NULL;
     }
+
+    if(!sl->patterns || !*sl->patterns)
+    {
+      g_string_append(buffer, sl->content);
+      g_string_append_c(buffer, '\n');
+      continue;
+    }
+
+    sl->source = JSStringCreateWithUTF8CString(sl->content);
+    for(char** pattern = sl->patterns; *pattern; pattern++)
+      index_script(sl, *pattern);
   }
 
-  g_object_set_data(G_OBJECT(GET_CURRENT_TAB()), "loaded_scripts",  (gpointer) 1);
+  if(buffer->len)
+    Jumanji.Global.script_bundle = JSStringCreateWithUTF8CString(buffer->str);
+
+  Jumanji.Global.script_generation++;
+
+  g_string_free(buffer, TRUE);
+}
+
+void
+mark_tab_dirty(GtkWidget* tab)
+{
+  /* prerendered views are not part of the notebook */
+  if(!tab || g_object_get_data(G_OBJECT(tab), "dirty") || gtk_notebook_page_num(Jumanji.UI.view, tab) == -1)
+    return;
+
+  g_object_set_data(G_OBJECT(tab), "dirty", (gpointer) 1);
+  Jumanji.Global.dirty_tabs = g_list_prepend(Jumanji.Global.dirty_tabs, tab);
+}
+
+void
+mark_tabs_dirty(int first, int last)
+{
+  int number_of_tabs = gtk_notebook_get_n_pages(Jumanji.UI.view);
+
+  if(last < 0 || last >= number_of_tabs)
+    last = number_of_tabs - 1;
+
+  for(int i = (first < 0) ? 0 : first; i <= last; i++)
+    mark_tab_dirty(GTK_WIDGET(GET_NTH_TAB_WIDGET(i)));
 }
 
 void init_ui()
@@ -990,7 +3166,7 @@ void init_ui()
   Jumanji.UI.box               = GTK_BOX(gtk_vbox_new(FALSE, 0));
   Jumanji.UI.statusbar         = gtk_event_box_new();
   Jumanji.UI.statusbar_entries = GTK_BOX(gtk_hbox_new(FALSE, 0));
-  Jumanji.UI.tabbar            = gtk_hbox_new(TRUE, 0);
+  Jumanji.UI.tabbar            = gtk_drawing_area_new();
   Jumanji.UI.inputbar          = GTK_ENTRY(gtk_entry_new());
   Jumanji.UI.view              = GTK_NOTEBOOK(gtk_notebook_new());
 
@@ -1036,7 +3212,14 @@ void init_ui()
   g_signal_connect(GTK_EDITABLE(Jumanji.UI.inputbar), "changed",     G_CALLBACK(cb_inputbar_changed),    NULL);
   g_signal_connect(G_OBJECT(Jumanji.UI.inputbar), "activate",        G_CALLBACK(cb_inputbar_activate),   NULL);
 
+  /* tabbar */
+  gtk_widget_add_events(Jumanji.UI.tabbar, GDK_SCROLL_MASK);
+  g_signal_connect(G_OBJECT(Jumanji.UI.tabbar), "expose-event",  G_CALLBACK(cb_tabbar_expose),        NULL);
+  g_signal_connect(G_OBJECT(Jumanji.UI.tabbar), "scroll-event",  G_CALLBACK(cb_tabbar_scroll),        NULL);
+  g_signal_connect(G_OBJECT(Jumanji.UI.tabbar), "size-allocate", G_CALLBACK(cb_tabbar_size_allocate), NULL);
+
   /* view */
+  g_signal_connect(G_OBJECT(Jumanji.UI.view), "switch-page", G_CALLBACK(cb_view_switch_page), NULL);
   gtk_notebook_set_show_tabs(Jumanji.UI.view,   FALSE);
   gtk_notebook_set_show_border(Jumanji.UI.view, FALSE);
 
@@ -1075,26 +3258,35 @@ void notify(int level, char* message)
   if(!(GTK_WIDGET_VISIBLE(GTK_WIDGET(Jumanji.UI.inputbar))))
     gtk_widget_show(GTK_WIDGET(Jumanji.UI.inputbar));
 
-  switch(level)
-  {
-    case ERROR:
-      gtk_widget_modify_base(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.notification_e_bg));
-      gtk_widget_modify_text(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.notification_e_fg));
-      break;
-    case WARNING:
-      gtk_widget_modify_base(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.notification_w_bg));
-      gtk_widget_modify_text(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.notification_w_fg));
-      break;
-    default:
-      gtk_widget_modify_base(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.inputbar_bg));
-      gtk_widget_modify_text(GTK_WIDGET(Jumanji.UI.inputbar), GTK_STATE_NORMAL, &(Jumanji.Style.inputbar_fg));
-      break;
-  }
+  set_inputbar_style(level);
 
   if(message)
     gtk_entry_set_text(Jumanji.UI.inputbar, message);
 }
 
+void
+init_dns_cache()
+{
+  /* derive from the default resolver, so that only name lookups are replaced */
+  GResolver* parent = g_resolver_get_default();
+  GTypeQuery query;
+
+  g_type_query(G_OBJECT_TYPE(parent), &query);
+
+  GTypeInfo info = { query.class_size, NULL, NULL, resolver_class_init, NULL, NULL, query.instance_size, 0, NULL, NULL };
+  GType     type = g_type_register_static(G_OBJECT_TYPE(parent), "JumanjiResolver", &info, 0);
+
+  /* a resolver which can not be derived from is kept as it is */
+  if(type)
+  {
+    GResolver* resolver = g_object_new(type, NULL);
+    g_resolver_set_default(resolver);
+    g_object_unref(resolver);
+  }
+
+  g_object_unref(parent);
+}
+
 void
 init_jumanji()
 {
@@ -1104,15 +3296,62 @@ init_jumanji()
   Jumanji.Global.command_history     = NULL;
   Jumanji.Global.handlers            = NULL;
   Jumanji.Global.scripts             = NULL;
+  Jumanji.Global.script_bundle       = NULL;
+  Jumanji.Global.script_index        = NULL;
+  Jumanji.Global.rc_monitor          = NULL;
+  Jumanji.Global.rc_lines            = NULL;
+  Jumanji.Global.bridge_class        = NULL;
+  Jumanji.Global.search_pool         = NULL;
+  Jumanji.Global.script_generation   = 1;
   Jumanji.Global.markers             = NULL;
   Jumanji.Global.bookmarks           = NULL;
   Jumanji.Global.history             = NULL;
   Jumanji.Global.last_closed         = NULL;
   Jumanji.Global.allowed_plugins     = NULL;
   Jumanji.Global.allowed_plugin_uris = NULL;
+  Jumanji.Global.dirty_tabs          = NULL;
+  Jumanji.Global.focused_tab         = NULL;
+  Jumanji.Global.waterfall           = NULL;
+  Jumanji.Global.waterfall_source    = NULL;
   Jumanji.Global.init_ui             = FALSE;
+  Jumanji.Style.statusbar_ssl        = -1;
+  Jumanji.Style.inputbar_level       = -1;
   Jumanji.Bindings.sclist            = NULL;
   Jumanji.Bindings.bcmdlist          = NULL;
+  Jumanji.Tabbar.offset              = 0;
+  Jumanji.Hints.count                = 0;
+  Jumanji.Hints.length               = 0;
+  Jumanji.Hints.active               = 0;
+  Jumanji.Blocker.hosts              = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  Jumanji.Blocker.exception_hosts    = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  Jumanji.Blocker.rules              = g_array_new(FALSE, FALSE, sizeof(BlockRule));
+  Jumanji.Blocker.nodes              = g_array_new(FALSE, FALSE, sizeof(BlockNode));
+  Jumanji.Global.https_hosts         = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  Jumanji.DNS.cache                  = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_dns_entry);
+  Jumanji.DNS.parent                 = NULL;
+  Jumanji.DNS.hits                   = 0;
+  Jumanji.DNS.negative_hits          = 0;
+  Jumanji.DNS.expired                = 0;
+  Jumanji.DNS.misses                 = 0;
+  Jumanji.Scheduler.tabs             = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free_tab_requests);
+  Jumanji.Scheduler.tags             = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  Jumanji.Scheduler.focused          = NULL;
+  Jumanji.Scheduler.pruned           = 0;
+  Jumanji.Prefetch.hosts             = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  Jumanji.Prefetch.last              = 0;
+  Jumanji.Prefetch.pending           = NULL;
+  Jumanji.Prefetch.source            = 0;
+  Jumanji.Prerender.window           = NULL;
+  Jumanji.Prerender.view             = NULL;
+  Jumanji.Prerender.uri              = NULL;
+  Jumanji.Prerender.source           = 0;
+  Jumanji.Update.flags               = 0;
+  Jumanji.Update.source              = 0;
+  Jumanji.Update.timer               = g_timer_new();
+  Jumanji.Update.link                = NULL;
+
+  BlockNode root = {0, -1, -1, -1, -1, 0};
+  g_array_append_val(Jumanji.Blocker.nodes, root);
 
   /* webkit settings */
   Jumanji.Global.browser_settings = webkit_web_settings_new();
@@ -1120,8 +3359,16 @@ init_jumanji()
   /* GDK keymap */
   Jumanji.Global.keymap = gdk_keymap_get_default();
 
+  /* resolver */
+  init_dns_cache();
+
   /* libsoup session */
-  Jumanji.Soup.session = webkit_get_default_session();
+  Jumanji.Soup.session        = webkit_get_default_session();
+  Jumanji.Soup.cache          = NULL;
+  Jumanji.Soup.cookie_removed = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+  g_signal_connect(G_OBJECT(Jumanji.Soup.session), "request-queued",  G_CALLBACK(cb_session_request_queued),  NULL);
+  g_signal_connect(G_OBJECT(Jumanji.Soup.session), "request-started", G_CALLBACK(cb_session_request_started), NULL);
 }
 
 void
@@ -1180,12 +3427,9 @@ scheme_handler(char* uri)
   return FALSE;
 }
 
-void
-open_uri(WebKitWebView* web_view, char* uri)
+char*
+expand_uri(char* uri)
 {
-  if(!uri)
-    return;
-
   uri = g_strstrip(uri);
 
   gchar* new_uri = NULL;
@@ -1307,11 +3551,36 @@ open_uri(WebKitWebView* web_view, char* uri)
         g_strfreev(trunc_uri);
       }
     }
+    else if(strstr(uri, "://"))
+      new_uri = (g_str_has_prefix(uri, "http://") && is_https_host(uri + strlen("http://"))) ?
+        g_strconcat("https://", uri + strlen("http://"), NULL) : g_strdup(uri);
+    /* go straight to https if the host is known to support it */
     else
-      new_uri = strstr(uri, "://") ? g_strdup(uri) : g_strconcat("http://", uri, NULL);
+      new_uri = g_strconcat(is_https_host(uri) ? "https://" : "http://", uri, NULL);
   }
 
-  webkit_web_view_load_uri(web_view, new_uri);
+  return new_uri;
+}
+
+void
+open_uri(WebKitWebView* web_view, char* uri)
+{
+  if(!uri)
+    return;
+
+  gchar* new_uri = expand_uri(uri);
+  if(!new_uri)
+    return;
+
+  /* the waterfall tab becomes an ordinary one */
+  if(web_view == Jumanji.Global.waterfall)
+  {
+    Jumanji.Global.waterfall        = NULL;
+    Jumanji.Global.waterfall_source = NULL;
+  }
+
+  if(!swap_prerendered(web_view, new_uri))
+    webkit_web_view_load_uri(web_view, new_uri);
 
   /* update history */
   if(!private_browsing)
@@ -1332,7 +3601,7 @@ open_uri(WebKitWebView* web_view, char* uri)
 
   g_free(new_uri);
 
-  update_status();
+  schedule_update(UPDATE_STATUS);
 }
 
 void
@@ -1358,65 +3627,118 @@ update_status()
   gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.tabs, tabs);
   g_free(tabs);
 
-  /* update tabbar */
-  int tc = 0;
-  for(tc = 0; tc < number_of_tabs; tc++)
+  /* update tabbar: only the dirty tabs and the old and new focused tab */
+  GtkWidget* tab = GTK_WIDGET(GET_CURRENT_TAB_WIDGET());
+  if(tab != Jumanji.Global.focused_tab)
   {
-    GtkWidget* tab       = GTK_WIDGET(GET_NTH_TAB_WIDGET(tc));
-    GtkWidget *tev_box   = GTK_WIDGET(g_object_get_data(G_OBJECT(tab), "tab"));
-    GtkWidget *tab_label = GTK_WIDGET(g_object_get_data(G_OBJECT(tab), "label"));
-
-    if(tc == current_tab)
-    {
-      gtk_widget_modify_bg(GTK_WIDGET(tev_box),   GTK_STATE_NORMAL, &(Jumanji.Style.tabbar_focus_bg));
-      gtk_widget_modify_fg(GTK_WIDGET(tab_label), GTK_STATE_NORMAL, &(Jumanji.Style.tabbar_focus_fg));
-    }
-    else
-    {
-      gtk_widget_modify_bg(GTK_WIDGET(tev_box),   GTK_STATE_NORMAL, &(Jumanji.Style.tabbar_bg));
-      gtk_widget_modify_fg(GTK_WIDGET(tab_label), GTK_STATE_NORMAL, &(Jumanji.Style.tabbar_fg));
-    }
+    mark_tab_dirty(Jumanji.Global.focused_tab);
+    mark_tab_dirty(tab);
+    Jumanji.Global.focused_tab = tab;
 
-    const gchar* tab_title = webkit_web_view_get_title(GET_WEBVIEW(tab));
-    int progress = webkit_web_view_get_progress(GET_WEBVIEW(tab)) * 100;
-    gchar* n_tab_title = g_strdup_printf("%d | %s", tc + 1, tab_title ? tab_title : ((progress == 100) ? "Loading..." : "(Untitled)"));
-    gtk_label_set_text((GtkLabel*) tab_label, n_tab_title);
-    g_free(n_tab_title);
+    update_tabbar_offset(current_tab);
   }
 
+  for(GList* list = Jumanji.Global.dirty_tabs; list; list = g_list_next(list))
+    update_tab(GTK_WIDGET(list->data));
+
+  g_list_free(Jumanji.Global.dirty_tabs);
+  Jumanji.Global.dirty_tabs = NULL;
+
   update_position();
 }
 
 void
-update_uri()
+update_tab(GtkWidget* tab)
 {
-  gchar* link  = (gchar*) webkit_web_view_get_uri(GET_CURRENT_TAB());
-  int progress = webkit_web_view_get_progress(GET_CURRENT_TAB()) * 100;
-  gchar* uri   = (progress != 100 && progress != 0) ? g_strdup_printf("Loading... %s (%d%%)", link ? link : "", progress) :
-                 (link ? g_strdup(link) : NULL);
+  g_object_set_data(G_OBJECT(tab), "dirty", NULL);
 
-  /* check for https */
-  GdkColor* fg;
-  GdkColor* bg;
+  int tc = gtk_notebook_page_num(Jumanji.UI.view, tab);
+  if(tc == -1)
+    return;
+
+  gboolean damaged = FALSE;
+
+  /* redraw only if the focus state changed (1 = normal, 2 = focus) */
+  int focus = (tab == Jumanji.Global.focused_tab) ? 2 : 1;
+  if(GPOINTER_TO_INT(g_object_get_data(G_OBJECT(tab), "focus")) != focus)
+  {
+    g_object_set_data(G_OBJECT(tab), "focus", GINT_TO_POINTER(focus));
+    damaged = TRUE;
+  }
+
+  /* relabel only if the label text changed */
+  const gchar* tab_title = webkit_web_view_get_title(GET_WEBVIEW(tab));
+  int progress = webkit_web_view_get_progress(GET_WEBVIEW(tab)) * 100;
+  gchar* n_tab_title = g_strdup_printf("%d | %s", tc + 1, tab_title ? tab_title : ((progress == 100) ? "Loading..." : "(Untitled)"));
 
-  gboolean ssl = link ? g_str_has_prefix(link, "https://") : FALSE;
-  if(ssl)
+  if(g_strcmp0(n_tab_title, g_object_get_data(G_OBJECT(tab), "label_text")))
   {
-    fg = &(Jumanji.Style.statusbar_ssl_fg);
-    bg = &(Jumanji.Style.statusbar_ssl_bg);
+    pango_layout_set_text(PANGO_LAYOUT(g_object_get_data(G_OBJECT(tab), "layout")), n_tab_title, -1);
+    g_object_set_data_full(G_OBJECT(tab), "label_text", n_tab_title, g_free);
+    damaged = TRUE;
   }
   else
+    g_free(n_tab_title);
+
+  /* redraw only the damaged region of the tabbar */
+  if(damaged)
+  {
+    GtkAllocation allocation;
+    gtk_widget_get_allocation(Jumanji.UI.tabbar, &allocation);
+
+    int width = get_tab_width();
+    gtk_widget_queue_draw_area(Jumanji.UI.tabbar, tc * width - Jumanji.Tabbar.offset, 0, width, allocation.height);
+  }
+}
+
+void
+set_tabbar_offset(int offset)
+{
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(Jumanji.UI.tabbar, &allocation);
+
+  /* do not scroll beyond the last tab */
+  int max = gtk_notebook_get_n_pages(Jumanji.UI.view) * get_tab_width() - allocation.width;
+  offset  = CLAMP(offset, 0, MAX(max, 0));
+
+  if(offset != Jumanji.Tabbar.offset)
+  {
+    Jumanji.Tabbar.offset = offset;
+    gtk_widget_queue_draw(Jumanji.UI.tabbar);
+  }
+}
+
+void
+update_tabbar_offset(int visible_tab)
+{
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(Jumanji.UI.tabbar, &allocation);
+
+  int width  = get_tab_width();
+  int offset = Jumanji.Tabbar.offset;
+
+  /* scroll the given tab into view */
+  if(visible_tab >= 0)
   {
-    fg = &(Jumanji.Style.statusbar_fg);
-    bg = &(Jumanji.Style.statusbar_bg);
+    if(visible_tab * width < offset)
+      offset = visible_tab * width;
+    else if((visible_tab + 1) * width > offset + allocation.width)
+      offset = (visible_tab + 1) * width - allocation.width;
   }
 
-  gtk_widget_modify_bg(GTK_WIDGET(Jumanji.UI.statusbar),      GTK_STATE_NORMAL,  bg);
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.text),     GTK_STATE_NORMAL, fg);
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.buffer),   GTK_STATE_NORMAL, fg);
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.tabs),     GTK_STATE_NORMAL, fg);
-  gtk_widget_modify_fg(GTK_WIDGET(Jumanji.Statusbar.position), GTK_STATE_NORMAL, fg);
+  set_tabbar_offset(offset);
+}
+
+void
+update_uri()
+{
+  gchar* link  = (gchar*) webkit_web_view_get_uri(GET_CURRENT_TAB());
+  int progress = webkit_web_view_get_progress(GET_CURRENT_TAB()) * 100;
+  gchar* uri   = (progress != 100 && progress != 0) ? g_strdup_printf("Loading... %s (%d%%)", link ? link : "", progress) :
+                 (link ? g_strdup(link) : NULL);
 
+  /* check for https */
+  set_statusbar_style(link ? g_str_has_prefix(link, "https://") : FALSE);
 
   /* check for possible navigation */
   if(!uri)
@@ -1438,6 +3760,15 @@ update_uri()
     }
 
     g_string_free(navigation, TRUE);
+
+    /* blocked requests */
+    int blocked = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(GET_CURRENT_TAB()), "blocked_requests"));
+    if(blocked)
+    {
+      char* new_uri = g_strdup_printf("%s [%d blocked]", uri, blocked);
+      g_free(uri);
+      uri = new_uri;
+    }
   }
 
   gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.text, uri);
@@ -1465,6 +3796,23 @@ update_position()
   else
     position = g_strdup_printf("%2d%%", (int) ceil(((value / max) * 100)));
 
+  /* search matches */
+  GObject* wv = G_OBJECT(GET_CURRENT_TAB());
+  if(g_object_get_data(wv, "search_query"))
+  {
+    int count = GPOINTER_TO_INT(g_object_get_data(wv, "search_count"));
+    int index = GPOINTER_TO_INT(g_object_get_data(wv, "search_index"));
+
+    const char* more = (count >= search_mark_limit && search_mark_limit) ? "+" : "";
+
+    /* the ordinal is unknown after a new query and for matches inside of
+     * frames, which have no ordinal in the main document */
+    gchar* matches = index > 0 ? g_strdup_printf("[%d/%d%s] %s", index, count, more, position) :
+                                 g_strdup_printf("[%d%s] %s", count, more, position);
+    g_free(position);
+    position = matches;
+  }
+
   gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.position, position);
   g_free(position);
 }
@@ -1483,39 +3831,87 @@ read_configuration()
 
     if(g_file_get_contents(jumanjirc, &content, NULL, NULL))
     {
-      gchar **lines = g_strsplit(content, "\n", -1);
-      int     n     = g_strv_length(lines) - 1;
+      apply_configuration(content);
+      g_free(content);
+    }
+  }
 
-      int i;
-      for(i = 0; i <= n; i++)
-      {
-        if(!strlen(lines[i]))
-          continue;
+  /* reload the configuration whenever it changes */
+  if(!Jumanji.Global.rc_monitor)
+  {
+    GFile* file = g_file_new_for_path(jumanjirc);
+    Jumanji.Global.rc_monitor = g_file_monitor_file(file, G_FILE_MONITOR_NONE, NULL, NULL);
+    g_object_unref(file);
 
-        gchar **tokens = g_strsplit(lines[i], " ", -1);
-        int     length = g_strv_length(tokens);
-
-        if(!strcmp(tokens[0], "set"))
-          cmd_set(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "map"))
-          cmd_map(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "bmap"))
-          cmd_bmap(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "searchengine"))
-          cmd_search_engine(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "script"))
-          cmd_script(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "plugin"))
-          cmd_plugintype(length - 1, tokens + 1);
-        else if(!strcmp(tokens[0], "scheme"))
-          cmd_schemehandler(length - 1, tokens + 1);
-      }
-    }
+    if(Jumanji.Global.rc_monitor)
+      g_signal_connect(G_OBJECT(Jumanji.Global.rc_monitor), "changed", G_CALLBACK(cb_config_changed), NULL);
   }
 
   g_free(jumanjirc);
 }
 
+void
+apply_configuration(char* content)
+{
+  gchar **lines = g_strsplit(content, "\n", -1);
+  int     n     = g_strv_length(lines) - 1;
+
+  int i;
+  for(i = 0; i <= n; i++)
+  {
+    if(!strlen(lines[i]))
+      continue;
+
+    /* apply only lines that are new since the last time */
+    gboolean applied = FALSE;
+    for(gchar** line = Jumanji.Global.rc_lines; line && *line && !applied; line++)
+      applied = !strcmp(*line, lines[i]);
+
+    if(applied)
+      continue;
+
+    gchar **tokens = g_strsplit(lines[i], " ", -1);
+    int     length = g_strv_length(tokens);
+
+    if(!strcmp(tokens[0], "set"))
+      cmd_set(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "map"))
+      cmd_map(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "bmap"))
+      cmd_bmap(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "searchengine"))
+      cmd_search_engine(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "script"))
+      cmd_script(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "plugin"))
+      cmd_plugintype(length - 1, tokens + 1);
+    else if(!strcmp(tokens[0], "scheme"))
+      cmd_schemehandler(length - 1, tokens + 1);
+  }
+
+  g_strfreev(Jumanji.Global.rc_lines);
+  Jumanji.Global.rc_lines = lines;
+}
+
+void
+monitor_script(ScriptList* script)
+{
+  gchar* path;
+
+  if(script->path[0] == '~')
+    path = g_build_filename(g_get_home_dir(), script->path + 1, NULL);
+  else
+    path = g_strdup(script->path);
+
+  GFile* file = g_file_new_for_path(path);
+  script->monitor = g_file_monitor_file(file, G_FILE_MONITOR_NONE, NULL, NULL);
+  g_object_unref(file);
+  g_free(path);
+
+  if(script->monitor)
+    g_signal_connect(G_OBJECT(script->monitor), "changed", G_CALLBACK(cb_script_changed), script);
+}
+
 char*
 read_file(const char* path)
 {
@@ -1558,6 +3954,40 @@ read_file(const char* path)
   return NULL;
 }
 
+void
+remove_tab(int position)
+{
+  GtkWidget* tab = GTK_WIDGET(GET_NTH_TAB_WIDGET(position));
+
+  /* forget cached tabbar state */
+  Jumanji.Global.dirty_tabs = g_list_remove(Jumanji.Global.dirty_tabs, tab);
+  if(Jumanji.Global.focused_tab == tab)
+    Jumanji.Global.focused_tab = NULL;
+
+  /* release cached function handles */
+  WebKitWebFrame* frame = webkit_web_view_get_main_frame(GET_WEBVIEW(tab));
+  if(frame)
+    clear_script_functions(GET_WEBVIEW(tab), webkit_web_frame_get_global_context(frame));
+
+  /* forget scheduled requests */
+  g_hash_table_remove(Jumanji.Scheduler.tabs, GET_WEBVIEW(tab));
+  forget_request_tags(GET_WEBVIEW(tab), 0);
+  if(Jumanji.Scheduler.focused == GET_WEBVIEW(tab))
+    Jumanji.Scheduler.focused = NULL;
+
+  /* forget the waterfall tab and the tab it shows */
+  if(Jumanji.Global.waterfall == GET_WEBVIEW(tab))
+  {
+    Jumanji.Global.waterfall        = NULL;
+    Jumanji.Global.waterfall_source = NULL;
+  }
+  if(Jumanji.Global.waterfall_source == GET_WEBVIEW(tab))
+    Jumanji.Global.waterfall_source = NULL;
+
+  gtk_notebook_remove_page(Jumanji.UI.view, position);
+  gtk_widget_queue_draw(Jumanji.UI.tabbar);
+}
+
 char*
 reference_to_string(JSContextRef context, JSValueRef reference)
 {
@@ -1573,6 +4003,254 @@ reference_to_string(JSContextRef context, JSValueRef reference)
   return string;
 }
 
+gboolean
+call_script_function(char* name, char* argument, char** value)
+{
+  WebKitWebView*  wv    = GET_CURRENT_TAB();
+  WebKitWebFrame* frame = webkit_web_view_get_main_frame(wv);
+
+  if(!frame)
+    return FALSE;
+
+  JSContextRef context  = webkit_web_frame_get_global_context(frame);
+  JSObjectRef  function = get_script_function(wv, context, name);
+
+  if(!function)
+    return FALSE;
+
+  /* pass the argument as a string value, it is never parsed as source */
+  JSValueRef arguments[1];
+  size_t     n_arguments = 0;
+
+  if(argument)
+  {
+    JSStringRef string = JSStringCreateWithUTF8CString(argument);
+    arguments[n_arguments++] = JSValueMakeString(context, string);
+    JSStringRelease(string);
+  }
+
+  JSValueRef exception = NULL;
+  JSValueRef va = JSObjectCallAsFunction(context, function, NULL, n_arguments, arguments, &exception);
+
+  if(va && value)
+    *value = reference_to_string(context, va);
+
+  return va != NULL;
+}
+
+/* The ordinal of the selected search match is the number of matches in
+ * the text between the start of the document and the selection. Like the
+ * find of WebKit it skips elements without a box and script or style
+ * content. It walks the whole document in front of the selection, so it
+ * is only run when the ordinal can not be stepped. */
+static const char* search_ordinal_source =
+  "var selection = window.getSelection();"
+  "if(!selection.rangeCount || !document.body) return 0;"
+  "var start = selection.getRangeAt(0), text = [];"
+  "var walker = document.createTreeWalker(document.body, NodeFilter.SHOW_ELEMENT | NodeFilter.SHOW_TEXT, { acceptNode: function(n) {"
+  "  if(n.nodeType == Node.TEXT_NODE) return NodeFilter.FILTER_ACCEPT;"
+  "  var tag = n.tagName.toLowerCase();"
+  "  return (tag == 'script' || tag == 'style' || tag == 'noscript' || !n.getClientRects().length) ? NodeFilter.FILTER_REJECT : NodeFilter.FILTER_SKIP;"
+  "} }, false);"
+  "for(var n = walker.nextNode(); n; n = walker.nextNode()) {"
+  "  if(n == start.startContainer) { text.push(n.data.substring(0, start.startOffset)); break; }"
+  "  if(start.comparePoint(n, 0) >= 0) break;"
+  "  text.push(n.data);"
+  "}"
+  "text = text.join('').toLowerCase(); query = query.toLowerCase();"
+  "var count = 1;"
+  "for(var i = text.indexOf(query); i != -1; i = text.indexOf(query, i + query.length)) count++;"
+  "return count;";
+
+JSObjectRef
+get_script_function(WebKitWebView* wv, JSContextRef context, char* name)
+{
+  if(!context)
+    return NULL;
+
+  GHashTable* functions = g_object_get_data(G_OBJECT(wv), "script_functions");
+  if(!functions)
+  {
+    functions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_object_set_data_full(G_OBJECT(wv), "script_functions", functions, (GDestroyNotify) g_hash_table_destroy);
+  }
+
+  /* look up every function only once per document */
+  JSObjectRef function = g_hash_table_lookup(functions, name);
+  if(function)
+    return function;
+
+  /* the built-in hinting engine is compiled on first use */
+  if(g_str_has_prefix(name, "hints."))
+  {
+    load_hints(wv, context, functions);
+    return g_hash_table_lookup(functions, name);
+  }
+
+  if(!strcmp(name, "search.ordinal"))
+  {
+    JSStringRef body      = JSStringCreateWithUTF8CString(search_ordinal_source);
+    JSStringRef parameter = JSStringCreateWithUTF8CString("query");
+    function              = JSObjectMakeFunction(context, NULL, 1, &parameter, body, NULL, 1, NULL);
+    JSStringRelease(parameter);
+    JSStringRelease(body);
+
+    if(function)
+    {
+      JSValueProtect(context, function);
+      g_hash_table_insert(functions, g_strdup(name), function);
+    }
+
+    return function;
+  }
+
+  JSStringRef js_name = JSStringCreateWithUTF8CString(name);
+  JSValueRef  va      = JSObjectGetProperty(context, JSContextGetGlobalObject(context), js_name, NULL);
+  JSStringRelease(js_name);
+
+  if(!va || !JSValueIsObject(context, va))
+    return NULL;
+
+  function = JSValueToObject(context, va, NULL);
+  if(!function || !JSObjectIsFunction(context, function))
+    return NULL;
+
+  JSValueProtect(context, function);
+  g_hash_table_insert(functions, g_strdup(name), function);
+
+  return function;
+}
+
+/* The hinting engine only looks at elements intersecting the viewport of
+ * the page and its visible frames. Subtrees whose box lies outside of the
+ * viewport are skipped as a whole, empty boxes like inline wrappers are
+ * still entered. Labels and filtering are done in C, the overlays are
+ * inserted into the document at once. */
+static const char* hint_source =
+  "var elements = [], container = null, overlays = [];"
+  "var selector = 'a[href], area[href], input:not([type=hidden]), textarea, select, button, [onclick], [role=link], [role=button]';"
+  "function clear() {"
+  "  if(container && container.parentNode) container.parentNode.removeChild(container);"
+  "  container = null; overlays = [];"
+  "}"
+  "function collect() {"
+  "  elements = [];"
+  "  (function walk(win, dx, dy, width, height) {"
+  "    var doc = win.document, root = doc.documentElement;"
+  "    if(!root) return;"
+  "    function outside(r) { return r.bottom + dy < 0 || r.right + dx < 0 || r.top + dy > height || r.left + dx > width; }"
+  "    var walker = doc.createTreeWalker(root, NodeFilter.SHOW_ELEMENT, { acceptNode: function(e) {"
+  "      var r = e.getBoundingClientRect();"
+  "      return ((r.width || r.height) && outside(r)) ? NodeFilter.FILTER_REJECT : NodeFilter.FILTER_ACCEPT;"
+  "    } }, false);"
+  "    for(var e = walker.currentNode; e; e = walker.nextNode()) {"
+  "      var tag = e.tagName.toLowerCase();"
+  "      if(tag == 'iframe' || tag == 'frame') {"
+  "        try {"
+  "          var b = e.getBoundingClientRect();"
+  "          walk(e.contentWindow, dx + b.left + e.clientLeft, dy + b.top + e.clientTop, width, height);"
+  "        } catch(x) {}"
+  "        continue;"
+  "      }"
+  "      if(!(e.matches || e.webkitMatchesSelector).call(e, selector)) continue;"
+  "      var r = e.getClientRects()[0];"
+  "      if(!r || outside(r)) continue;"
+  "      elements.push([e, Math.max(r.left + dx, 0), Math.max(r.top + dy, 0)]);"
+  "    }"
+  "  })(window, 0, 0, window.innerWidth, window.innerHeight);"
+  "  return elements.length;"
+  "}"
+  "function show(labels) {"
+  "  clear(); labels = labels.split(',');"
+  "  container = document.createElement('div');"
+  "  for(var i = 0; i < elements.length; i++) {"
+  "    var o = document.createElement('span');"
+  "    o.textContent = labels[i];"
+  "    o.style.cssText = 'position:fixed;z-index:2147483647;left:' + elements[i][1] + 'px;top:' + elements[i][2] + 'px;"
+  "background:#FFF712;color:#000;border:1px solid #000;padding:0 2px;font:bold 11px monospace;';"
+  "    overlays.push(o); container.appendChild(o);"
+  "  }"
+  "  (document.body || document.documentElement).appendChild(container);"
+  "}"
+  "function filter(mask) {"
+  "  for(var i = 0; i < overlays.length; i++) {"
+  "    overlays[i].style.display = (mask.charAt(i) == '0') ? 'none' : '';"
+  "    overlays[i].style.background = (mask.charAt(i) == '2') ? '#9FBC00' : '#FFF712';"
+  "  }"
+  "}"
+  "function activate(i) {"
+  "  var e = elements[i] ? elements[i][0] : null; clear();"
+  "  if(!e) return '';"
+  "  var tag = e.tagName.toLowerCase();"
+  "  if(tag == 'input' || tag == 'textarea' || tag == 'select') {"
+  "    setTimeout(function() { e.focus(); jumanji.setMode('insert'); }, 0);"
+  "    return '';"
+  "  }"
+  "  if(e.href) return e.href;"
+  "  var ev = e.ownerDocument.createEvent('MouseEvents');"
+  "  ev.initMouseEvent('click', true, true, e.ownerDocument.defaultView, 0, 0, 0, 0, 0, false, false, false, false, 0, null);"
+  "  e.dispatchEvent(ev);"
+  "  return '';"
+  "}"
+  "function href(i) {"
+  "  var e = elements[i] ? elements[i][0] : null;"
+  "  return (e && e.href) ? String(e.href) : '';"
+  "}"
+  "return { activate: activate, clear: clear, collect: collect, filter: filter, href: href, show: show };";
+
+void
+load_hints(WebKitWebView* wv, JSContextRef context, GHashTable* functions)
+{
+  JSStringRef body      = JSStringCreateWithUTF8CString(hint_source);
+  JSStringRef parameter = JSStringCreateWithUTF8CString("jumanji");
+  JSObjectRef factory   = JSObjectMakeFunction(context, NULL, 1, &parameter, body, NULL, 1, NULL);
+  JSStringRelease(parameter);
+  JSStringRelease(body);
+
+  if(!factory)
+    return;
+
+  /* the engine keeps its state and the bridge in a closure, nothing leaks
+   * into the page */
+  JSValueRef arguments[1] = { create_bridge(wv, context) };
+  JSValueRef va = JSObjectCallAsFunction(context, factory, NULL, 1, arguments, NULL);
+  if(!va || !JSValueIsObject(context, va))
+    return;
+
+  JSObjectRef hints     = JSValueToObject(context, va, NULL);
+  const char* methods[] = { "activate", "clear", "collect", "filter", "href", "show", NULL };
+
+  for(int i = 0; methods[i]; i++)
+  {
+    JSStringRef name     = JSStringCreateWithUTF8CString(methods[i]);
+    JSValueRef  function = JSObjectGetProperty(context, hints, name, NULL);
+    JSStringRelease(name);
+
+    if(!function || !JSValueIsObject(context, function))
+      continue;
+
+    JSValueProtect(context, function);
+    g_hash_table_insert(functions, g_strconcat("hints.", methods[i], NULL), (gpointer) function);
+  }
+}
+
+void
+clear_script_functions(WebKitWebView* wv, JSContextRef context)
+{
+  GHashTable* functions = g_object_get_data(G_OBJECT(wv), "script_functions");
+  if(!functions || !context)
+    return;
+
+  GHashTableIter iter;
+  gpointer       function;
+
+  g_hash_table_iter_init(&iter, functions);
+  while(g_hash_table_iter_next(&iter, NULL, &function))
+    JSValueUnprotect(context, (JSValueRef) function);
+
+  g_hash_table_remove_all(functions);
+}
+
 void
 run_script(char* script, char** value, char** error)
 {
@@ -1605,6 +4283,23 @@ run_script(char* script, char** value, char** error)
     *value = reference_to_string(context, va);
 }
 
+void
+schedule_update(int flags)
+{
+  Jumanji.Update.flags |= flags;
+
+  if(Jumanji.Update.source)
+    return;
+
+  /* coalesce all pending updates and flush them at most once per frame */
+  guint elapsed = g_timer_elapsed(Jumanji.Update.timer, NULL) * 1000;
+
+  if(elapsed >= (guint) update_interval)
+    Jumanji.Update.source = g_idle_add(cb_update_status, NULL);
+  else
+    Jumanji.Update.source = g_timeout_add(update_interval - elapsed, cb_update_status, NULL);
+}
+
 void
 set_completion_row_color(GtkBox* results, int mode, int id)
 {
@@ -1631,6 +4326,42 @@ set_completion_row_color(GtkBox* results, int mode, int id)
   }
 }
 
+void
+set_inputbar_style(int level)
+{
+  if(level != ERROR && level != WARNING)
+    level = DEFAULT;
+
+  /* restyle only on transitions */
+  if(level == Jumanji.Style.inputbar_level)
+    return;
+
+  GtkRcStyle* style = (level == ERROR) ? Jumanji.Style.notification_e_style :
+                      (level == WARNING) ? Jumanji.Style.notification_w_style : Jumanji.Style.inputbar_style;
+
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.UI.inputbar), style);
+
+  Jumanji.Style.inputbar_level = level;
+}
+
+void
+set_statusbar_style(gboolean ssl)
+{
+  /* restyle only on transitions */
+  if(ssl == Jumanji.Style.statusbar_ssl)
+    return;
+
+  GtkRcStyle* style = ssl ? Jumanji.Style.statusbar_ssl_style : Jumanji.Style.statusbar_style;
+
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.UI.statusbar),       style);
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.Statusbar.text),     style);
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.Statusbar.buffer),   style);
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.Statusbar.tabs),     style);
+  gtk_widget_modify_style(GTK_WIDGET(Jumanji.Statusbar.position), style);
+
+  Jumanji.Style.statusbar_ssl = ssl;
+}
+
 void
 switch_view(GtkWidget* UNUSED(widget))
 {
@@ -1782,6 +4513,116 @@ void completion_group_add_element(CompletionGroup* group, char* name, char* desc
     group->elements = new_element;
 }
 
+gboolean
+show_hints()
+{
+  int base = strlen(hint_characters);
+  if(base < 2)
+    return FALSE;
+
+  char* value = NULL;
+  if(!call_script_function("hints.collect", NULL, &value))
+    return FALSE;
+
+  Jumanji.Hints.count  = value ? atoi(value) : 0;
+  Jumanji.Hints.active = 0;
+  g_free(value);
+
+  if(Jumanji.Hints.count <= 0)
+    return FALSE;
+
+  /* all labels have the same length, so none is a prefix of another */
+  Jumanji.Hints.length = 1;
+  for(int n = base; n < Jumanji.Hints.count; n *= base)
+    Jumanji.Hints.length++;
+
+  GString* labels = g_string_sized_new(Jumanji.Hints.count * (Jumanji.Hints.length + 1));
+  char*    label  = g_malloc(Jumanji.Hints.length + 1);
+
+  label[Jumanji.Hints.length] = '\0';
+
+  for(int i = 0; i < Jumanji.Hints.count; i++)
+  {
+    for(int j = Jumanji.Hints.length - 1, n = i; j >= 0; j--, n /= base)
+      label[j] = hint_characters[n % base];
+
+    if(i)
+      g_string_append_c(labels, ',');
+    g_string_append(labels, label);
+  }
+
+  call_script_function("hints.show", labels->str, NULL);
+
+  g_free(label);
+  g_string_free(labels, TRUE);
+
+  return TRUE;
+}
+
+gboolean
+get_hint_range(int* first, int* last)
+{
+  int   base   = strlen(hint_characters);
+  char* prefix = Jumanji.Global.buffer ? Jumanji.Global.buffer->str : "";
+  int   length = strlen(prefix);
+
+  if(base < 2 || length > Jumanji.Hints.length)
+    return FALSE;
+
+  /* labels are numbers in base of the hint characters, a typed prefix
+   * selects a contiguous range of them */
+  int value = 0;
+  int range = 1;
+
+  for(int i = 0; i < Jumanji.Hints.length; i++)
+  {
+    if(i < length)
+    {
+      char* c = strchr(hint_characters, prefix[i]);
+      if(!c)
+        return FALSE;
+
+      value = value * base + (c - hint_characters);
+    }
+    else
+      range *= base;
+  }
+
+  *first = value * range;
+  *last  = MIN(*first + range, Jumanji.Hints.count) - 1;
+
+  return *first <= *last;
+}
+
+void
+update_hints(int first, int last)
+{
+  if(Jumanji.Hints.active < first || Jumanji.Hints.active > last)
+    Jumanji.Hints.active = first;
+
+  char* mask = g_malloc(Jumanji.Hints.count + 1);
+
+  for(int i = 0; i < Jumanji.Hints.count; i++)
+    mask[i] = (i == Jumanji.Hints.active) ? '2' : ((i >= first && i <= last) ? '1' : '0');
+  mask[Jumanji.Hints.count] = '\0';
+
+  call_script_function("hints.filter", mask, NULL);
+  g_free(mask);
+
+  /* a single candidate is likely followed */
+  if(first == last)
+  {
+    char* index = g_strdup_printf("%d", first);
+    char* uri   = NULL;
+
+    if(call_script_function("hints.href", index, &uri) && prefetch_uri(uri))
+      prerender_uri(uri);
+
+    g_free(uri);
+    g_free(index);
+  }
+}
+
 /* shortcut implementation */
 void
 sc_abort(Argument* UNUSED(argument))
@@ -1795,8 +4636,8 @@ sc_abort(Argument* UNUSED(argument))
   }
 
   /* Clear hints */
-  char* cmd = "clear()";
-  run_script(cmd, NULL, NULL);
+  if(Jumanji.Global.mode == FOLLOW)
+    call_script_function("hints.clear", NULL, NULL);
 
   /* Stop loading website */
   if(webkit_web_view_get_progress(GET_CURRENT_TAB()) != 0.0 && Jumanji.Global.mode != FOLLOW)
@@ -1859,7 +4700,6 @@ void
 sc_close_tab(Argument* UNUSED(argument))
 {
   int current_tab      = gtk_notebook_get_current_page(Jumanji.UI.view);
-  GtkWidget* tab       = GTK_WIDGET(GET_NTH_TAB_WIDGET(current_tab));
 
   /* remove markers for this tab
    * and update the others */
@@ -1886,9 +4726,9 @@ sc_close_tab(Argument* UNUSED(argument))
 
   if(gtk_notebook_get_n_pages(Jumanji.UI.view) > 1)
   {
-    gtk_container_remove(GTK_CONTAINER(Jumanji.UI.tabbar), GTK_WIDGET(g_object_get_data(G_OBJECT(tab), "tab")));
-    gtk_notebook_remove_page(Jumanji.UI.view, current_tab);
-    update_status();
+    remove_tab(current_tab);
+    mark_tabs_dirty(current_tab, -1);
+    schedule_update(UPDATE_STATUS);
   }
   else
     open_uri(GET_CURRENT_TAB(), home_page);
@@ -1944,30 +4784,46 @@ sc_follow_link(Argument* argument)
   /* show all links */
   if(!follow_links || Jumanji.Global.mode != FOLLOW)
   {
-    run_script("show_hints()", NULL, NULL);
+    if(!show_hints())
+    {
+      notify(WARNING, "No links to follow");
+      return;
+    }
+
     change_mode(FOLLOW);
     follow_links = TRUE;
     return;
   }
 
-  char* value = NULL;
-  char* cmd   = NULL;
+  /* filter the hints by the typed prefix */
+  int first, last;
+  if(!get_hint_range(&first, &last))
+  {
+    sc_abort(NULL);
+    return;
+  }
 
-  if (argument && argument->n == 10)
-    cmd = g_strdup("get_active()");
-  else if (key && key->keyval == GDK_Tab) {
+  if (key && key->keyval == GDK_Tab) {
     if ( key->state & GDK_CONTROL_MASK)
-      cmd = g_strdup("focus_prev()");
+      Jumanji.Hints.active = (Jumanji.Hints.active > first) ? Jumanji.Hints.active - 1 : last;
     else
-      cmd = g_strdup("focus_next()");
+      Jumanji.Hints.active = (Jumanji.Hints.active < last) ? Jumanji.Hints.active + 1 : first;
+  }
+
+  if(!(argument && argument->n == 10) && first != last)
+  {
+    update_hints(first, last);
+    return;
   }
-  else if(Jumanji.Global.buffer && Jumanji.Global.buffer->len > 0)
-    cmd = g_strconcat("update_hints(\"", Jumanji.Global.buffer->str, "\")", NULL);
 
-  run_script(cmd, &value, NULL);
-  g_free(cmd);
+  /* follow the active or the only remaining hint */
+  char* value  = NULL;
+  char* active = g_strdup_printf("%d", (first == last) ? first : Jumanji.Hints.active);
 
-  if(value && strcmp(value, "undefined") && !scheme_handler(value))
+  call_script_function("hints.activate", active, &value);
+  g_free(active);
+
+  if(value && strlen(value) && !scheme_handler(value))
   {
     if(open_mode == -1)
       open_uri(GET_CURRENT_TAB(), value);
@@ -1975,6 +4831,7 @@ sc_follow_link(Argument* argument)
       create_tab(value, TRUE);
   }
 
+  g_free(value);
   sc_abort(NULL);
 }
 
@@ -2154,13 +5011,7 @@ sessionswitch(char* session_name)
   /* remove all the tabs
    * without updating the status bar */
   for (int i = gtk_notebook_get_n_pages(Jumanji.UI.view) - 1; i != -1; --i)
-  {
-    GtkWidget* tab = GTK_WIDGET(GET_NTH_TAB_WIDGET(i));
-
-    gtk_container_remove(GTK_CONTAINER(Jumanji.UI.tabbar), GTK_WIDGET(g_object_get_data(G_OBJECT(tab), "tab")));
-
-    gtk_notebook_remove_page(Jumanji.UI.view, i);
-  }
+    remove_tab(i);
 
   gboolean foo = next_to_current;
   next_to_current = FALSE;
@@ -2516,6 +5367,14 @@ isc_completion(Argument* argument)
         }
       }
 
+      /* resolve the host of the top uri */
+      if(commands[previous_id].completion == cc_open)
+      {
+        for(int i = 0; i < n_items; i++)
+          if(!rows[i].is_group && prefetch_uri(rows[i].command))
+            break;
+      }
+
       /* clean up */
       completion_free(result);
     }
@@ -2615,6 +5474,10 @@ isc_completion(Argument* argument)
     gtk_editable_set_position(GTK_EDITABLE(Jumanji.UI.inputbar), -1);
     g_free(temp);
 
+    /* the selected uri is likely opened next */
+    if(!command_mode && commands[rows[current_item].command_id].completion == cc_open)
+      prerender_uri(rows[current_item].command);
+
     previous_command   = (command_mode) ? rows[current_item].command : current_command;
     previous_parameter = (command_mode) ? current_parameter : rows[current_item].command;
     previous_length    = strlen(previous_command);
@@ -2850,6 +5713,23 @@ cmd_bookmark(int argc, char** argv)
   return TRUE;
 }
 
+gboolean
+cmd_dnsstats(int UNUSED(argc), char** UNUSED(argv))
+{
+  G_LOCK(dns_cache);
+
+  gchar* message = g_strdup_printf("DNS: %d hits, %d negative hits, %d expired, %d misses, %d cached hosts",
+      Jumanji.DNS.hits, Jumanji.DNS.negative_hits, Jumanji.DNS.expired, Jumanji.DNS.misses,
+      g_hash_table_size(Jumanji.DNS.cache));
+
+  G_UNLOCK(dns_cache);
+
+  notify(DEFAULT, message);
+  g_free(message);
+
+  return TRUE;
+}
+
 gboolean
 cmd_forward(int UNUSED(argc), char** UNUSED(argv))
 {
@@ -3134,6 +6014,8 @@ cmd_saveas(int argc, char** argv)
   char* file      = g_strconcat(download_dir, filename ? filename : uri, NULL);
   char* command   = g_strdup_printf(download_command, uri, file);
 
+  /* the download command reads the cookie file */
+  flush_cookies();
   g_spawn_command_line_async(command, NULL);
 
   g_free(command);
@@ -3159,17 +6041,26 @@ cmd_script(int argc, char** argv)
     return FALSE;
   }
 
+  /* the remaining arguments restrict the script to matching sites */
+  char** patterns = (argc > 1) ? g_strdupv(argv + 1) : NULL;
+
   /* search for existing script to overwrite or reread it */
   ScriptList* sl = Jumanji.Global.scripts;
-  while(sl && sl->next != NULL)
+  while(sl)
   {
     if(!strcmp(sl->path, path))
     {
-      sl->path    = path;
-      sl->content = content;
+      g_free(sl->content);
+      g_strfreev(sl->patterns);
+      sl->content  = content;
+      sl->patterns = patterns;
+      update_script_bundle();
       return TRUE;
     }
 
+    if(!sl->next)
+      break;
+
     sl = sl->next;
   }
 
@@ -3178,9 +6069,14 @@ cmd_script(int argc, char** argv)
   if(!entry)
     out_of_memory();
 
-  entry->path    = path;
-  entry->content = content;
-  entry->next    = NULL;
+  entry->path     = g_strdup(path);
+  entry->content  = content;
+  entry->patterns = patterns;
+  entry->source   = NULL;
+  entry->monitor  = NULL;
+  entry->next     = NULL;
+
+  monitor_script(entry);
 
   /* append to list */
   if(!Jumanji.Global.scripts)
@@ -3189,6 +6085,106 @@ cmd_script(int argc, char** argv)
   if(sl)
     sl->next = entry;
 
+  update_script_bundle();
+
+  return TRUE;
+}
+
+gboolean
+cmd_searchall(int argc, char** argv)
+{
+  if(argc < 1)
+    return TRUE;
+
+  /* a completion looks like "#<tab>.<match> <term>", a term may well
+   * start with numbers on its own */
+  int tab    = -1;
+  int match  = 0;
+  int length = 0;
+
+  if(argc > 1 && sscanf(argv[0], "#%d.%d%n", &tab, &match, &length) == 2 && !argv[0][length] && tab > 0 && match > 0)
+  {
+    tab   -= 1;
+    match -= 1;
+    argc  -= 1;
+    argv  += 1;
+  }
+  else
+  {
+    tab   = -1;
+    match = 0;
+  }
+
+  gchar* term = g_strjoinv(" ", argv);
+
+  /* without a completion jump to the first tab that contains the term */
+  if(tab < 0)
+  {
+    GList* jobs = search_all_tabs(term);
+
+    for(GList* list = jobs; list; list = g_list_next(list))
+    {
+      SearchAllJob* job = (SearchAllJob*) list->data;
+
+      if(job->matches && tab < 0)
+        tab = job->tab;
+
+      for(GList* match = job->matches; match; match = g_list_next(match))
+        g_free(match->data);
+
+      g_list_free(job->matches);
+      g_free(job);
+    }
+
+    g_list_free(jobs);
+  }
+
+  if(tab < 0 || tab >= gtk_notebook_get_n_pages(Jumanji.UI.view))
+  {
+    gchar* message = g_strdup_printf("No tab contains '%s'", term);
+    notify(WARNING, message);
+    g_free(message);
+    g_free(term);
+    return FALSE;
+  }
+
+  gtk_notebook_set_current_page(Jumanji.UI.view, tab);
+  gtk_widget_grab_focus(GTK_WIDGET(GET_CURRENT_TAB_WIDGET()));
+  schedule_update(UPDATE_STATUS);
+
+  /* highlight the term and move to the selected match, counting from the
+   * top of the page instead of from wherever the selection was */
+  g_free(search_item);
+  search_item = term;
+
+  g_object_set_data(G_OBJECT(GET_CURRENT_TAB()), "search_query", NULL);
+  run_script("window.getSelection().removeAllRanges()", NULL, NULL);
+
+  Argument argument = {FORWARD, NULL};
+  for(int i = 0; i <= match; i++)
+    search_and_highlight(&argument);
+
+  return TRUE;
+}
+
+gboolean
+cmd_searchstats(int UNUSED(argc), char** UNUSED(argv))
+{
+  GObject* wv   = G_OBJECT(GET_CURRENT_TAB());
+  int      last = GPOINTER_TO_INT(g_object_get_data(wv, "search_last_cost"));
+  int      cost = GPOINTER_TO_INT(g_object_get_data(wv, "search_cost"));
+
+  if(!cost)
+  {
+    notify(DEFAULT, "No search on this tab yet");
+    return TRUE;
+  }
+
+  gchar* message = g_strdup_printf("Search: last %.1f ms, average %.1f ms, delay %d ms",
+      last / 1000.0, cost / 1000.0, get_search_delay(GET_CURRENT_TAB()));
+  notify(DEFAULT, message);
+  g_free(message);
+
   return TRUE;
 }
 
@@ -3234,26 +6230,38 @@ cmd_search_engine(int argc, char** argv)
 }
 
 gboolean
-cmd_set(int argc, char** argv)
+set_option(int argc, char** argv, gboolean local)
 {
   if(argc <= 0)
     return TRUE;
 
-  /* get webkit settings */
-  WebKitWebSettings* browser_settings;
-  if(Jumanji.UI.view && gtk_notebook_get_current_page(Jumanji.UI.view) >= 0)
-    browser_settings = webkit_web_view_get_settings(GET_CURRENT_TAB());
-  else
-    browser_settings = Jumanji.Global.browser_settings;
-
   WebKitWebView* current_wv = NULL;
   if(Jumanji.UI.view && gtk_notebook_get_current_page(Jumanji.UI.view) >= 0)
     current_wv = GET_CURRENT_TAB();
 
+  if(local && !current_wv)
+    return TRUE;
+
+  /* get webkit settings: the shared settings apply to every tab at once, a
+   * local override copies the settings of the current tab on first write */
+  WebKitWebSettings* browser_settings = Jumanji.Global.browser_settings;
+
   for(unsigned int i = 0; i < LENGTH(settings); i++)
   {
     if(!strcmp(argv[0], settings[i].name))
     {
+      /* only webkit settings exist per tab, jumanji's own variables are global */
+      if(local && !settings[i].webkitvar)
+      {
+        notify(WARNING, "This option can not be set for a single tab");
+        return TRUE;
+      }
+
+      if(local)
+      {
+        browser_settings = get_local_settings(current_wv);
+        g_hash_table_insert(g_object_get_data(G_OBJECT(current_wv), "local_overrides"), settings[i].webkitvar, (gpointer) 1);
+      }
       /* check var type */
       if(settings[i].type == 'b')
       {
@@ -3266,14 +6274,24 @@ cmd_set(int argc, char** argv)
           else
             value = TRUE;
         }
+        else if(local)
+        {
+          /* toggle the value of this tab like :set toggles the global one */
+          gboolean current = FALSE;
+          GObject* object = settings[i].webkitview ? G_OBJECT(current_wv) : G_OBJECT(browser_settings);
+          g_object_get(object, settings[i].webkitvar, &current, NULL);
+          value = !current;
+        }
 
-        if(settings[i].variable)
+        if(settings[i].variable && !local)
         {
           gboolean *x = (gboolean*) (settings[i].variable);
           *x = !(*x);
 
           if(argv[1])
             *x = value;
+          else
+            value = *x;
         }
 
         /* check browser settings */
@@ -3300,7 +6318,7 @@ cmd_set(int argc, char** argv)
         if(id == -1)
           id = atoi(argv[1]);
 
-        if(settings[i].variable)
+        if(settings[i].variable && !local)
         {
           int *x = (int*) (settings[i].variable);
           *x = id;
@@ -3317,7 +6335,7 @@ cmd_set(int argc, char** argv)
 
         float value = atof(argv[1]);
 
-        if(settings[i].variable)
+        if(settings[i].variable && !local)
         {
           float *x = (float*) (settings[i].variable);
           *x = value;
@@ -3335,7 +6353,26 @@ cmd_set(int argc, char** argv)
         /* assembly the arguments back to one string */
         gchar* s = g_strjoinv(" ", &(argv[1]));
 
-        if(settings[i].variable)
+        /* every hint character has to be a distinct digit of the labels */
+        if(settings[i].variable == &hint_characters)
+        {
+          GString* unique = g_string_new(NULL);
+          for(char* c = s; *c; c++)
+            if(!g_ascii_isspace(*c) && !strchr(unique->str, *c))
+              g_string_append_c(unique, *c);
+
+          g_free(s);
+          if(unique->len < 2)
+          {
+            g_string_free(unique, TRUE);
+            notify(WARNING, "hint_characters needs at least two different characters");
+            return TRUE;
+          }
+
+          s = g_string_free(unique, FALSE);
+        }
+
+        if(settings[i].variable && !local)
         {
           char **x = (char**) settings[i].variable;
           *x = s;
@@ -3345,6 +6382,10 @@ cmd_set(int argc, char** argv)
         if(settings[i].webkitvar)
           g_object_set(G_OBJECT(browser_settings), settings[i].webkitvar, s, NULL);
 
+        /* the settings object keeps its own copy */
+        if(local)
+          g_free(s);
+
         // a memory leak can append here
       }
       else if(settings[i].type == 'c')
@@ -3354,7 +6395,7 @@ cmd_set(int argc, char** argv)
 
         char value = argv[1][0];
 
-        if(settings[i].variable)
+        if(settings[i].variable && !local)
         {
           char *x = (char*) (settings[i].variable);
           *x = value;
@@ -3365,6 +6406,14 @@ cmd_set(int argc, char** argv)
           g_object_set(G_OBJECT(browser_settings), settings[i].webkitvar, value, NULL);
       }
 
+      /* keep the tab-local copies in sync */
+      if(settings[i].webkitvar && !local && Jumanji.UI.view)
+        sync_local_settings(settings[i].webkitvar);
+
+      /* the cache is attached by init_data() after the configuration is read */
+      if((settings[i].variable == &cache_size || settings[i].variable == &private_browsing) && Jumanji.Global.init_ui)
+        update_disk_cache();
+
       /* reload */
       if(settings[i].reload && Jumanji.UI.view)
         if(gtk_notebook_get_current_page(Jumanji.UI.view) >= 0)
@@ -3387,12 +6436,28 @@ cmd_set(int argc, char** argv)
       gtk_widget_show(GTK_WIDGET(Jumanji.UI.tabbar));
     else
       gtk_widget_hide(GTK_WIDGET(Jumanji.UI.tabbar));
+
+    /* the tab width might have changed */
+    update_tabbar_offset(gtk_notebook_get_current_page(Jumanji.UI.view));
+    gtk_widget_queue_draw(GTK_WIDGET(Jumanji.UI.tabbar));
   }
 
-  update_status();
+  schedule_update(UPDATE_STATUS);
   return TRUE;
 }
 
+gboolean
+cmd_set(int argc, char** argv)
+{
+  return set_option(argc, argv, FALSE);
+}
+
+gboolean
+cmd_setlocal(int argc, char** argv)
+{
+  return set_option(argc, argv, TRUE);
+}
+
 gboolean
 cmd_stop(int UNUSED(argc), char** UNUSED(argv))
 {
@@ -3539,6 +6604,84 @@ cmd_schemehandler(int argc, char** argv)
   return TRUE;
 }
 
+gboolean
+cmd_loadstats(int argc, char** argv)
+{
+  WebKitWebView* wv = GET_CURRENT_TAB();
+
+  /* the waterfall tab stands for the tab it shows */
+  if(wv == Jumanji.Global.waterfall && Jumanji.Global.waterfall_source)
+    wv = Jumanji.Global.waterfall_source;
+
+  LoadTimeline* timeline = get_load_timeline(wv);
+
+  /* export the timeline of the current page */
+  if(argc > 0)
+  {
+    char* file = (argv[0][0] == '~') ? g_build_filename(g_get_home_dir(), argv[0] + 1, NULL) : g_strdup(argv[0]);
+
+    if(export_load_timeline(wv, file))
+      notify(DEFAULT, "Load timeline exported");
+    else
+      notify(WARNING, "Could not write the load timeline");
+
+    g_free(file);
+    return TRUE;
+  }
+
+  /* sum up the phases of the requests of the current page */
+  int        requests = 0, cached = 0, reused = 0;
+  goffset    bytes    = 0;
+  gint64     dns = 0, connect = 0, wait = 0, first = 0, last = 0, slowest = 0;
+  LoadEntry* slowest_entry = NULL;
+
+  for(int i = 0; i < timeline->count; i++)
+  {
+    LoadEntry* entry = &timeline->entries[i];
+    if(entry->started < timeline->page_start)
+      continue;
+
+    requests++;
+    bytes  += entry->bytes;
+    cached += entry->cache_hit ? 1 : 0;
+    reused += entry->reused ? 1 : 0;
+
+    if(entry->dns_end && entry->dns_start)
+      dns += entry->dns_end - entry->dns_start;
+    if(entry->connect_end && entry->connect_start)
+      connect += MAX(entry->connect_end, entry->tls_end) - entry->connect_start;
+    if(entry->first_byte)
+      wait += entry->first_byte - (entry->sent ? entry->sent : entry->queued);
+
+    first = (!first || entry->queued < first) ? entry->queued : first;
+    last  = MAX(last, entry->complete);
+
+    if(entry->complete - entry->queued > slowest)
+    {
+      slowest       = entry->complete - entry->queued;
+      slowest_entry = entry;
+    }
+  }
+
+  if(!requests)
+  {
+    notify(DEFAULT, "No requests recorded for this page");
+    return TRUE;
+  }
+
+  /* the waterfall opens in its own tab, the summary stays in the inputbar */
+  show_load_waterfall(wv);
+
+  gchar* message = g_strdup_printf("Load: %d requests, %ld KB, %d cached, %d on reused connections, %ld ms | dns %ld ms, connect %ld ms, wait %ld ms | slowest %ld ms %s",
+      requests, (long) (bytes / 1024), cached, reused, (long) ((last - first) / 1000),
+      (long) (dns / 1000), (long) (connect / 1000), (long) (wait / 1000),
+      (long) (slowest / 1000), slowest_entry->uri);
+  notify(DEFAULT, message);
+  g_free(message);
+
+  return TRUE;
+}
+
 gboolean
 cmd_winopen(int argc, char** argv)
 {
@@ -3606,6 +6749,13 @@ cmd_write(int UNUSED(argc), char** UNUSED(argv))
   g_free(history_file);
   g_string_free(history_list, TRUE);
 
+  /* save https hosts */
+  save_https_hosts();
+
+  /* save dns cache, private browsing leaves no trace of the visited hosts */
+  if(!private_browsing)
+    save_dns_cache();
+
   if(!default_session_name)
     return TRUE;
 
@@ -3726,20 +6876,72 @@ cc_open(char* input)
     CompletionGroup* history = completion_group_create("History");
     completion_add_group(completion, history);
 
-    for(GList* h = Jumanji.Global.history; h; h = g_list_next(h))
+    for(GList* h = Jumanji.Global.history; h; h = g_list_next(h))
+    {
+      char* uri = (char*) h->data;
+      gchar* lowercase_uri = g_utf8_strdown(uri, -1);
+
+      /* case insensitive search */
+      if(strstr(lowercase_uri, lowercase_input))
+        completion_group_add_element(history, uri, NULL);
+
+      g_free(lowercase_uri);
+    }
+  }
+
+  g_free(lowercase_input);
+
+  return completion;
+}
+
+Completion*
+cc_searchall(char* input)
+{
+  /* the completion rows keep pointing to these strings */
+  static GList* strings = NULL;
+
+  for(GList* list = strings; list; list = g_list_next(list))
+    g_free(list->data);
+
+  g_list_free(strings);
+  strings = NULL;
+
+  Completion* completion = completion_init();
+
+  if(!strlen(input))
+    return completion;
+
+  GList* jobs = search_all_tabs(input);
+
+  for(GList* list = jobs; list; list = g_list_next(list))
+  {
+    SearchAllJob* job = (SearchAllJob*) list->data;
+
+    /* one group per tab that contains the term */
+    if(job->matches)
     {
-      char* uri = (char*) h->data;
-      gchar* lowercase_uri = g_utf8_strdown(uri, -1);
+      const char* title = webkit_web_view_get_title(GET_NTH_TAB(job->tab));
+      gchar* name = g_strdup_printf("%d | %s", job->tab + 1, title ? title : "(Untitled)");
 
-      /* case insensitive search */
-      if(strstr(lowercase_uri, lowercase_input))
-        completion_group_add_element(history, uri, NULL);
+      CompletionGroup* group = completion_group_create(name);
+      completion_add_group(completion, group);
+      strings = g_list_prepend(strings, name);
 
-      g_free(lowercase_uri);
+      int n = 1;
+      for(GList* match = job->matches; match; match = g_list_next(match), n++)
+      {
+        gchar* value = g_strdup_printf("#%d.%d %s", job->tab + 1, n, input);
+        completion_group_add_element(group, value, match->data);
+        strings = g_list_prepend(strings, value);
+        strings = g_list_prepend(strings, match->data);
+      }
     }
+
+    g_list_free(job->matches);
+    g_free(job);
   }
 
-  g_free(lowercase_input);
+  g_list_free(jobs);
 
   return completion;
 }
@@ -3901,12 +7103,11 @@ bcmd_move_tab(char* buffer, Argument* argument)
     new = total;
 
   GtkWidget *tab = GTK_WIDGET(GET_CURRENT_TAB_WIDGET());
-  GtkWidget *tabbar_entry = GTK_WIDGET(g_object_get_data(G_OBJECT(tab), "tab"));
 
   gtk_notebook_reorder_child(Jumanji.UI.view, tab, new);
-  gtk_box_reorder_child(GTK_BOX(Jumanji.UI.tabbar), tabbar_entry, new);
 
-  update_status();
+  mark_tabs_dirty(MIN(current, new), MAX(current, new));
+  schedule_update(UPDATE_STATUS);
 }
 
 void
@@ -3941,7 +7142,7 @@ bcmd_nav_tabs(char* buffer, Argument* argument)
   {
     gtk_notebook_set_current_page(Jumanji.UI.view, new_tab);
     gtk_widget_grab_focus(GTK_WIDGET(GET_CURRENT_TAB_WIDGET()));
-    update_status();
+    schedule_update(UPDATE_STATUS);
   }
 }
 
@@ -3999,109 +7200,592 @@ bcmd_toggle_sourcecode(char* UNUSED(buffer), Argument* argument)
 
     g_spawn_command_line_async(command, NULL);
 
-    g_free(command);
-  }
-  else
-    sc_toggle_sourcecode(argument);
+    g_free(command);
+  }
+  else
+    sc_toggle_sourcecode(argument);
+}
+
+void
+bcmd_zoom(char* buffer, Argument* argument)
+{
+  float zoom_level = webkit_web_view_get_zoom_level(GET_CURRENT_TAB());
+
+  if(argument->n == ZOOM_IN)
+    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), zoom_level + (float) (zoom_step / 100));
+  else if(argument->n == ZOOM_OUT)
+    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), zoom_level - (float) (zoom_step / 100));
+  else if(argument->n == ZOOM_ORIGINAL)
+    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), 1.0f);
+  else if(argument->n == SPECIFIC)
+  {
+    char* number = g_strndup(buffer, strlen(buffer) - 1);
+    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), (float) (atoi(number) / 100));
+    g_free(number);
+  }
+}
+
+/* special command implementation */
+gboolean
+scmd_search(char* input, Argument* argument, gboolean activate)
+{
+  static guint search_and_highlight_id;
+
+  if((input && !strlen(input)) || activate)
+    return TRUE;
+
+  argument->data = input;
+
+  g_free(search_item);
+  search_item = g_strdup(input);
+
+  gboolean source_removed = FALSE;
+  if(search_and_highlight_id)
+  {
+    source_removed = g_source_remove(search_and_highlight_id);
+    search_and_highlight_id = 0;
+  }
+
+  /* if function was launched by cb_inputbar_activate */
+  if(activate)
+  {
+    if(source_removed)
+      search_and_highlight(argument);
+  }
+  else
+    search_and_highlight_id = g_timeout_add(get_search_delay(GET_CURRENT_TAB()), (GSourceFunc)sc_search, argument);
+
+  return TRUE;
+}
+
+int
+get_search_delay(WebKitWebView* wv)
+{
+  int cost = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(wv), "search_cost"));
+
+  /* wait about as long as a search takes, so fast pages react immediately
+   * and slow pages skip the queries typed in between */
+  if(!cost)
+    return search_delay;
+
+  return CLAMP(cost * 2 / 1000, search_delay_min, search_delay);
+}
+
+char*
+get_text_snapshot(WebKitWebView* wv)
+{
+  char* text = g_object_get_data(G_OBJECT(wv), "text_snapshot");
+  if(text)
+    return text;
+
+  WebKitWebFrame* frame = webkit_web_view_get_main_frame(wv);
+  if(!frame)
+    return NULL;
+
+  JSContextRef context = webkit_web_frame_get_global_context(frame);
+  if(!context)
+    return NULL;
+
+  JSStringRef script = JSStringCreateWithUTF8CString("document.body ? document.body.innerText : ''");
+  JSValueRef  va     = JSEvaluateScript(context, script, JSContextGetGlobalObject(context), NULL, 0, NULL);
+  JSStringRelease(script);
+
+  /* keep the lowercased text until the page changes, every search of all
+   * tabs is case insensitive */
+  char* content = reference_to_string(context, va);
+  if(!content)
+    return NULL;
+
+  text = g_utf8_strdown(content, -1);
+  g_object_set_data_full(G_OBJECT(wv), "text_snapshot", text, g_free);
+  g_free(content);
+
+  return text;
+}
+
+GList*
+search_all_tabs(char* term)
+{
+  gchar*       lowercase_term = g_utf8_strdown(term, -1);
+  GAsyncQueue* done           = g_async_queue_new();
+  GList*       jobs           = NULL;
+  int          pushed         = 0;
+
+  /* the pool lives as long as jumanji, its threads are shared */
+  if(!Jumanji.Global.search_pool)
+    Jumanji.Global.search_pool = g_thread_pool_new(search_all_worker, NULL, g_get_num_processors(), FALSE, NULL);
+
+  /* the text of the tabs is extracted here, searching it happens on the
+   * worker threads */
+  for(int i = 0; i < gtk_notebook_get_n_pages(Jumanji.UI.view); i++)
+  {
+    SearchAllJob* job = g_new0(SearchAllJob, 1);
+    job->tab  = i;
+    job->text = get_text_snapshot(GET_NTH_TAB(i));
+    job->term = lowercase_term;
+    job->done = done;
+
+    jobs = g_list_append(jobs, job);
+
+    if(!job->text)
+      continue;
+
+    if(Jumanji.Global.search_pool)
+    {
+      g_thread_pool_push(Jumanji.Global.search_pool, job, NULL);
+      pushed++;
+    }
+    else
+      search_all_worker(job, NULL);
+  }
+
+  /* wait for all jobs of this search */
+  for(int i = 0; i < pushed; i++)
+    g_async_queue_pop(done);
+
+  g_async_queue_unref(done);
+  g_free(lowercase_term);
+
+  return jobs;
+}
+
+void
+search_all_worker(gpointer data, gpointer UNUSED(user_data))
+{
+  SearchAllJob* job    = (SearchAllJob*) data;
+  char*         text   = job->text;
+  char*         end    = text + strlen(text);
+  size_t        length = strlen(job->term);
+  int           n      = 0;
+
+  if(!length)
+  {
+    g_async_queue_push(job->done, job);
+    return;
+  }
+
+  for(char* match = strstr(text, job->term); match && n < SEARCH_ALL_MATCHES; match = strstr(match + length, job->term), n++)
+  {
+    /* some context around the match, without splitting characters */
+    char* first = (match - text > SEARCH_ALL_CONTEXT) ? match - SEARCH_ALL_CONTEXT : text;
+    char* last  = (end - match > (int) length + SEARCH_ALL_CONTEXT) ? match + length + SEARCH_ALL_CONTEXT : end;
+
+    while(first > text && (*first & 0xC0) == 0x80)
+      first--;
+    while(last < end && (*last & 0xC0) == 0x80)
+      last++;
+
+    gchar* snippet = g_strndup(first, last - first);
+    g_strdelimit(snippet, "\n\r\t", ' ');
+
+    job->matches = g_list_append(job->matches, snippet);
+  }
+
+  g_async_queue_push(job->done, job);
+}
+
+gboolean
+search_and_highlight(Argument* argument)
+{
+  if(!search_item || !strlen(search_item))
+    return FALSE;
+
+  WebKitWebView* current_wv = GET_CURRENT_TAB();
+  GTimer*        timer      = g_timer_new();
+  const char*    query      = g_object_get_data(G_OBJECT(current_wv), "search_query");
+  int            count      = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(current_wv), "search_count"));
+  int            index      = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(current_wv), "search_index"));
+  gboolean       new_query  = g_strcmp0(query, search_item) != 0;
+
+  if(new_query)
+  {
+    /* a longer query can only match where the shorter one did, so there is
+     * nothing to mark if the shorter one did not match at all */
+    if(!query || count || g_ascii_strncasecmp(search_item, query, strlen(query)))
+    {
+      webkit_web_view_unmark_text_matches(current_wv);
+      count = webkit_web_view_mark_text_matches(current_wv, search_item, FALSE, search_mark_limit);
+      webkit_web_view_set_highlight_text_matches(current_wv, TRUE);
+    }
+
+    g_object_set_data_full(G_OBJECT(current_wv), "search_query", g_strdup(search_item), g_free);
+    index = 0;
+  }
+
+  gboolean direction = (argument->n == BACKWARD) ? FALSE : TRUE;
+
+  /* the ordinal is stepped with the selection, the matches in front of it
+   * are only counted when it is unknown or wraps beyond search_mark_limit,
+   * typing a new query leaves it unknown */
+  if(count && webkit_web_view_search_text(current_wv, search_item, FALSE, direction, TRUE) && !new_query)
+  {
+    if(index && (direction ? index < count : index > 1))
+      index += direction ? 1 : -1;
+    else if(index && (count < search_mark_limit || !search_mark_limit))
+      index = direction ? 1 : count;
+    else
+    {
+      char* ordinal = NULL;
+      index = call_script_function("search.ordinal", search_item, &ordinal) && ordinal ? atoi(ordinal) : 0;
+      g_free(ordinal);
+    }
+  }
+
+  g_object_set_data(G_OBJECT(current_wv), "search_count", GINT_TO_POINTER(count));
+  g_object_set_data(G_OBJECT(current_wv), "search_index", GINT_TO_POINTER(index));
+  schedule_update(UPDATE_POSITION);
+
+  /* measure the cost of a new query on this tab (in microseconds), only
+   * those are delayed, stepping through the matches is much cheaper */
+  if(new_query)
+  {
+    int last = g_timer_elapsed(timer, NULL) * 1000000;
+    int cost = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(current_wv), "search_cost"));
+
+    g_object_set_data(G_OBJECT(current_wv), "search_last_cost", GINT_TO_POINTER(MAX(last, 1)));
+    g_object_set_data(G_OBJECT(current_wv), "search_cost",      GINT_TO_POINTER(MAX(cost ? (3 * cost + last) / 4 : last, 1)));
+  }
+  g_timer_destroy(timer);
+
+  return FALSE;
+}
+
+/* callback implementation */
+UniqueResponse
+cb_app_message_received(UniqueApp* UNUSED(application), gint UNUSED(command), UniqueMessageData* message_data, guint UNUSED(time), gpointer UNUSED(data))
+{
+  if(message_data)
+    create_tab(unique_message_data_get_text(message_data), FALSE);
+
+  return UNIQUE_RESPONSE_OK;
+}
+
+gboolean
+cb_blank()
+{
+  return TRUE;
+}
+
+void
+cb_config_changed(GFileMonitor* UNUSED(monitor), GFile* file, GFile* UNUSED(other_file),
+    GFileMonitorEvent event, gpointer UNUSED(data))
+{
+  if(event != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT && event != G_FILE_MONITOR_EVENT_CREATED)
+    return;
+
+  /* read the configuration without blocking the ui */
+  g_file_load_contents_async(file, NULL, cb_config_loaded, NULL);
+}
+
+void
+cb_config_loaded(GObject* source, GAsyncResult* result, gpointer UNUSED(data))
+{
+  char* content = NULL;
+
+  if(!g_file_load_contents_finish(G_FILE(source), result, &content, NULL, NULL, NULL))
+    return;
+
+  apply_configuration(content);
+  g_free(content);
+}
+
+void
+cb_cookie_changed(SoupCookieJar* UNUSED(jar), SoupCookie* old_cookie, SoupCookie* new_cookie, gpointer UNUSED(data))
+{
+  /* remember deleted cookies, they must not be merged back from the file */
+  if(old_cookie && !new_cookie)
+    g_hash_table_insert(Jumanji.Soup.cookie_removed,
+        g_strdup_printf("%s\t%s\t%s", old_cookie->domain, old_cookie->path, old_cookie->name), (gpointer) 1);
+  else if(new_cookie)
+  {
+    gchar* key = g_strdup_printf("%s\t%s\t%s", new_cookie->domain, new_cookie->path, new_cookie->name);
+    g_hash_table_remove(Jumanji.Soup.cookie_removed, key);
+    g_free(key);
+  }
+
+  /* collect changes and write them at once */
+  if(!Jumanji.Soup.cookie_source)
+    Jumanji.Soup.cookie_source = g_timeout_add_seconds(MAX(cookie_save_interval, 0), save_cookies, NULL);
+}
+
+void
+cb_message_finished(SoupMessage* message, gpointer data)
+{
+  WebKitWebView* wv       = (WebKitWebView*) data;
+  TabRequests*   requests = g_hash_table_lookup(Jumanji.Scheduler.tabs, wv);
+
+  if(!requests || !g_list_find(requests->messages, message))
+    return;
+
+  /* move the timings into the ring buffer of the tab */
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(entry)
+  {
+    LoadTimeline* timeline = get_load_timeline(wv);
+    LoadEntry*    slot     = &timeline->entries[timeline->next];
+
+    g_free(slot->uri);
+    g_free(slot->method);
+
+    *slot             = *entry;
+    slot->uri         = soup_uri_to_string(soup_message_get_uri(message), FALSE);
+    slot->method      = g_strdup(message->method);
+    slot->status      = message->status_code;
+    slot->cache_hit   = message->status_code == SOUP_STATUS_NOT_MODIFIED;
+    slot->complete    = g_get_monotonic_time();
+
+    timeline->next  = (timeline->next + 1) % LOAD_TIMELINE_SIZE;
+    timeline->count = MIN(timeline->count + 1, LOAD_TIMELINE_SIZE);
+  }
+
+  requests->messages = g_list_remove(requests->messages, message);
+  requests->active--;
+
+  run_pending_requests(wv);
+}
+
+gboolean
+cb_prefetch_timeout(gpointer UNUSED(data))
+{
+  gchar* host = Jumanji.Prefetch.pending;
+
+  Jumanji.Prefetch.pending = NULL;
+  Jumanji.Prefetch.source  = 0;
+
+  if(host)
+    prefetch_host(host);
+
+  g_free(host);
+
+  return FALSE;
+}
+
+gboolean
+cb_prerender_timeout(gpointer UNUSED(data))
+{
+  /* the prediction was not used */
+  Jumanji.Prerender.source = 0;
+  discard_prerender();
+
+  return FALSE;
+}
+
+gboolean
+cb_release_web_view(gpointer data)
+{
+  GtkWidget* wv = GTK_WIDGET(data);
+
+  gtk_widget_destroy(wv);
+  g_object_unref(wv);
+
+  return FALSE;
+}
+
+void
+cb_message_got_chunk(SoupMessage* message, SoupBuffer* chunk, gpointer UNUSED(data))
+{
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(entry)
+    entry->bytes += chunk->length;
+}
+
+void
+cb_message_got_headers(SoupMessage* message, gpointer UNUSED(data))
+{
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(entry)
+    entry->first_byte = g_get_monotonic_time();
+
+  if(private_browsing)
+    return;
+
+  SoupURI* uri = soup_message_get_uri(message);
+  if(!uri || !uri->host)
+    return;
+
+  gchar* host = g_ascii_strdown(uri->host, -1);
+
+  /* learn hosts from Strict-Transport-Security headers ... */
+  if(uri->scheme == SOUP_URI_SCHEME_HTTPS)
+  {
+    const char* sts = soup_message_headers_get_one(message->response_headers, "Strict-Transport-Security");
+
+    if(sts)
+    {
+      gchar**  directives = g_strsplit(sts, ";", -1);
+      gboolean subdomains = FALSE;
+      gint64   max_age    = -1;
+
+      for(int i = 0; directives[i]; i++)
+      {
+        char* directive = g_strstrip(directives[i]);
+
+        if(!g_ascii_strncasecmp(directive, "max-age=", strlen("max-age=")))
+          max_age = g_ascii_strtoll(directive + strlen("max-age="), NULL, 10);
+        else if(!g_ascii_strcasecmp(directive, "includeSubDomains"))
+          subdomains = TRUE;
+      }
+
+      /* a max-age of 0 removes the host, it is kept as expired until the
+       * file has been written so other instances do not bring it back */
+      if(max_age == 0)
+        set_https_host(host, 0, FALSE);
+      else if(max_age > 0)
+        set_https_host(host, time(NULL) + max_age, subdomains);
+
+      g_strfreev(directives);
+    }
+  }
+  /* ... and from redirects of plain http to https on the same host */
+  else if(SOUP_STATUS_IS_REDIRECTION(message->status_code) && soup_uri_uses_default_port(uri))
+  {
+    const char* location = soup_message_headers_get_one(message->response_headers, "Location");
+
+    if(location && g_str_has_prefix(location, "https://"))
+    {
+      location += strlen("https://");
+
+      if(!g_ascii_strncasecmp(location, host, strlen(host)) && strchr("/?#", location[strlen(host)]))
+        set_https_host(host, time(NULL) + HTTPS_REDIRECT_TTL, FALSE);
+    }
+  }
+
+  g_free(host);
+}
+
+void
+cb_message_wrote_body(SoupMessage* message, gpointer UNUSED(data))
+{
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(entry)
+    entry->wrote = g_get_monotonic_time();
 }
 
 void
-bcmd_zoom(char* buffer, Argument* argument)
+cb_message_network_event(SoupMessage* message, GSocketClientEvent event, GIOStream* UNUSED(connection), gpointer UNUSED(data))
 {
-  float zoom_level = webkit_web_view_get_zoom_level(GET_CURRENT_TAB());
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(!entry)
+    return;
 
-  if(argument->n == ZOOM_IN)
-    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), zoom_level + (float) (zoom_step / 100));
-  else if(argument->n == ZOOM_OUT)
-    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), zoom_level - (float) (zoom_step / 100));
-  else if(argument->n == ZOOM_ORIGINAL)
-    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), 1.0f);
-  else if(argument->n == SPECIFIC)
+  gint64 now = g_get_monotonic_time();
+
+  switch(event)
   {
-    char* number = g_strndup(buffer, strlen(buffer) - 1);
-    webkit_web_view_set_zoom_level(GET_CURRENT_TAB(), (float) (atoi(number) / 100));
-    g_free(number);
+    case G_SOCKET_CLIENT_RESOLVING:
+      entry->dns_start = now;
+      break;
+    case G_SOCKET_CLIENT_RESOLVED:
+      entry->dns_end = now;
+      break;
+    case G_SOCKET_CLIENT_CONNECTING:
+      entry->connect_start = now;
+      break;
+    case G_SOCKET_CLIENT_CONNECTED:
+      entry->connect_end = now;
+      break;
+    case G_SOCKET_CLIENT_TLS_HANDSHAKING:
+      entry->tls_start = now;
+      break;
+    case G_SOCKET_CLIENT_TLS_HANDSHAKED:
+      entry->tls_end = now;
+      break;
+    default:
+      break;
   }
 }
 
-/* search (special)command global variables */
-char* search_item = NULL;
-gboolean search_item_changed = FALSE;
-
-/* special command implementation */
-gboolean
-scmd_search(char* input, Argument* argument, gboolean activate)
+void
+cb_resolver_lookup_done(GObject* source, GAsyncResult* result, gpointer data)
 {
-  static guint search_and_highlight_id;
+  GTask*  task  = G_TASK(data);
+  GError* error = NULL;
 
-  if((input && !strlen(input)) || activate)
-    return TRUE;
+  GList* addresses = Jumanji.DNS.parent->lookup_by_name_finish(G_RESOLVER(source), result, &error);
+  store_dns_entry(g_task_get_task_data(task), addresses, error);
 
-  argument->data = input;
+  if(error)
+    g_task_return_error(task, error);
+  else
+    g_task_return_pointer(task, addresses, (GDestroyNotify) g_resolver_free_addresses);
 
-  g_free(search_item);
-  search_item = g_strdup(input);
-  search_item_changed = TRUE;
+  g_object_unref(task);
+}
 
-  gboolean source_removed = FALSE;
-  if(search_and_highlight_id)
-  {
-    source_removed = g_source_remove(search_and_highlight_id);
-    search_and_highlight_id = 0;
-  }
+void
+cb_session_request_started(SoupSession* UNUSED(session), SoupMessage* message, SoupSocket* socket, gpointer UNUSED(data))
+{
+  LoadEntry* entry = g_object_get_data(G_OBJECT(message), "load_entry");
+  if(!entry)
+    return;
 
-  /* if function was launched by cb_inputbar_activate */
-  if(activate)
+  entry->sent = g_get_monotonic_time();
+
+  /* a socket which carried a request before is a reused connection, a new
+   * one had to connect, whether its TLS session was resumed is not known */
+  if(socket)
   {
-    if(source_removed)
-      search_and_highlight(argument);
+    entry->reused = g_object_get_data(G_OBJECT(socket), "connection_seen") != NULL;
+    g_object_set_data(G_OBJECT(socket), "connection_seen", GINT_TO_POINTER(1));
   }
-  else
-    search_and_highlight_id = g_timeout_add(search_delay, (GSourceFunc)sc_search, argument);
-
-  return TRUE;
 }
 
-gboolean
-search_and_highlight(Argument* argument)
+void
+cb_session_request_queued(SoupSession* session, SoupMessage* message, gpointer UNUSED(data))
 {
-  static WebKitWebView* last_wv = NULL;
-
-  if(search_item && !strlen(search_item))
-    return FALSE;
+  g_signal_connect(G_OBJECT(message), "got-headers", G_CALLBACK(cb_message_got_headers), NULL);
 
-  WebKitWebView* current_wv = GET_CURRENT_TAB();
+  /* webkit does not tell which tab a message belongs to, the request was
+   * tagged by its uri in resource-request-starting */
+  WebKitWebView* wv = take_request_tag(message);
+  if(!wv)
+    return;
 
-  if(search_item_changed || last_wv != current_wv)
+  TabRequests* requests = g_hash_table_lookup(Jumanji.Scheduler.tabs, wv);
+  if(!requests)
   {
-    webkit_web_view_unmark_text_matches(current_wv);
-    webkit_web_view_mark_text_matches(current_wv, search_item, FALSE, 0);
-    webkit_web_view_set_highlight_text_matches(current_wv, TRUE);
+    requests = malloc(sizeof(TabRequests));
+    if(!requests)
+      out_of_memory();
 
-    last_wv = current_wv;
+    requests->active   = 0;
+    requests->messages = NULL;
+    requests->pending  = g_queue_new();
+
+    g_hash_table_insert(Jumanji.Scheduler.tabs, wv, requests);
   }
 
-  gboolean direction = (argument->n == BACKWARD) ? FALSE : TRUE;
-  webkit_web_view_search_text(current_wv, search_item, FALSE, direction, TRUE);
+  requests->messages = g_list_prepend(requests->messages, message);
+  g_signal_connect_object(G_OBJECT(message), "finished", G_CALLBACK(cb_message_finished), wv, 0);
 
-  search_item_changed = FALSE;
-  return FALSE;
-}
+  /* record the load timeline of the tab */
+  LoadEntry* entry = g_new0(LoadEntry, 1);
+  entry->started   = g_get_real_time();
+  entry->queued    = g_get_monotonic_time();
 
-/* callback implementation */
-UniqueResponse
-cb_app_message_received(UniqueApp* UNUSED(application), gint UNUSED(command), UniqueMessageData* message_data, guint UNUSED(time), gpointer UNUSED(data))
-{
-  if(message_data)
-    create_tab(unique_message_data_get_text(message_data), FALSE);
+  g_object_set_data_full(G_OBJECT(message), "load_entry", entry, g_free);
+  g_signal_connect(G_OBJECT(message), "got-chunk",     G_CALLBACK(cb_message_got_chunk),     NULL);
+  g_signal_connect(G_OBJECT(message), "network-event", G_CALLBACK(cb_message_network_event), NULL);
+  g_signal_connect(G_OBJECT(message), "wrote-body",    G_CALLBACK(cb_message_wrote_body),    NULL);
 
-  return UNIQUE_RESPONSE_OK;
-}
+  /* the focused tab is dispatched first, background tabs share a few connections */
+  if(wv == Jumanji.Scheduler.focused)
+  {
+    soup_message_set_priority(message, SOUP_MESSAGE_PRIORITY_HIGH);
+    requests->active++;
+  }
+  else
+  {
+    soup_message_set_priority(message, SOUP_MESSAGE_PRIORITY_LOW);
 
-gboolean
-cb_blank()
-{
-  return TRUE;
+    if(requests->active < background_connections)
+      requests->active++;
+    else
+    {
+      soup_session_pause_message(session, message);
+      g_queue_push_tail(requests->pending, message);
+    }
+  }
 }
 
 gboolean
@@ -4109,9 +7793,51 @@ cb_destroy(GtkWidget* UNUSED(widget), gpointer UNUSED(data))
 {
   pango_font_description_free(Jumanji.Style.font);
 
+  /* clean styles */
+  g_object_unref(Jumanji.Style.statusbar_style);
+  g_object_unref(Jumanji.Style.statusbar_ssl_style);
+  g_object_unref(Jumanji.Style.inputbar_style);
+  g_object_unref(Jumanji.Style.notification_e_style);
+  g_object_unref(Jumanji.Style.notification_w_style);
+
   /* write bookmarks and history */
   cmd_write(0, NULL);
 
+  /* write pending cookie changes */
+  flush_cookies();
+  g_free(Jumanji.Soup.cookie_file);
+  g_hash_table_destroy(Jumanji.Soup.cookie_removed);
+
+  discard_prerender();
+  g_hash_table_destroy(Jumanji.Scheduler.tabs);
+  forget_request_tags(NULL, G_MAXINT64);
+  g_hash_table_destroy(Jumanji.Scheduler.tags);
+  g_hash_table_destroy(Jumanji.Prefetch.hosts);
+  g_free(Jumanji.Prefetch.pending);
+  if(Jumanji.Prefetch.source)
+    g_source_remove(Jumanji.Prefetch.source);
+  g_hash_table_destroy(Jumanji.Global.https_hosts);
+
+  /* clean content blocker */
+  for(unsigned int i = 0; i < Jumanji.Blocker.rules->len; i++)
+  {
+    g_free(BLOCK_RULE(i).prefix);
+    g_free(BLOCK_RULE(i).suffix);
+  }
+
+  g_array_free(Jumanji.Blocker.rules, TRUE);
+  g_array_free(Jumanji.Blocker.nodes, TRUE);
+  g_hash_table_destroy(Jumanji.Blocker.hosts);
+  g_hash_table_destroy(Jumanji.Blocker.exception_hosts);
+
+  /* write disk cache index */
+  if(Jumanji.Soup.cache)
+  {
+    soup_cache_flush(Jumanji.Soup.cache);
+    soup_cache_dump(Jumanji.Soup.cache);
+    g_object_unref(Jumanji.Soup.cache);
+  }
+
   /* clear bookmarks */
   GList* list;
   for(list = Jumanji.Global.bookmarks; list; list = g_list_next(list))
@@ -4153,11 +7879,33 @@ cb_destroy(GtkWidget* UNUSED(widget), gpointer UNUSED(data))
   {
     ScriptList* ne = sl->next;
     if(sl->content)
-      free(sl->content);
+      g_free(sl->content);
+    if(sl->source)
+      JSStringRelease(sl->source);
+    if(sl->monitor)
+      g_object_unref(sl->monitor);
+    g_strfreev(sl->patterns);
+    g_free(sl->path);
     free(sl);
     sl = ne;
   }
 
+  if(Jumanji.Global.script_bundle)
+    JSStringRelease(Jumanji.Global.script_bundle);
+
+  free_script_index(Jumanji.Global.script_index);
+
+  /* clean configuration monitor */
+  if(Jumanji.Global.rc_monitor)
+    g_object_unref(Jumanji.Global.rc_monitor);
+  g_strfreev(Jumanji.Global.rc_lines);
+
+  if(Jumanji.Global.bridge_class)
+    JSClassRelease(Jumanji.Global.bridge_class);
+
+  if(Jumanji.Global.search_pool)
+    g_thread_pool_free(Jumanji.Global.search_pool, TRUE, TRUE);
+
   /* clean handlers */
   HandlerList *hl = Jumanji.Global.handlers;
   HandlerList *ne = NULL;
@@ -4195,6 +7943,13 @@ cb_destroy(GtkWidget* UNUSED(widget), gpointer UNUSED(data))
 
   g_list_free(Jumanji.Global.allowed_plugin_uris);
 
+  /* clean pending updates */
+  if(Jumanji.Update.source)
+    g_source_remove(Jumanji.Update.source);
+
+  g_timer_destroy(Jumanji.Update.timer);
+  g_free(Jumanji.Update.link);
+
   gtk_main_quit();
 
   return TRUE;
@@ -4407,6 +8162,224 @@ cb_tab_kb_pressed(GtkWidget* UNUSED(widget), GdkEventKey* event, gpointer UNUSED
   return FALSE;
 }
 
+JSValueRef
+cb_js_open_uri(JSContextRef context, JSObjectRef UNUSED(function), JSObjectRef object,
+    size_t argc, const JSValueRef argv[], JSValueRef* UNUSED(exception))
+{
+  WebKitWebView* wv = JSObjectGetPrivate(object);
+
+  /* scripts of a prerendered page run before the user has opened it */
+  if(!wv || wv == Jumanji.Prerender.view || argc < 1)
+    return JSValueMakeUndefined(context);
+
+  char* uri = reference_to_string(context, argv[0]);
+
+  /* jumanji.openUri(uri, new_tab) */
+  if(uri && !scheme_handler(uri))
+  {
+    if(argc > 1 && JSValueToBoolean(context, argv[1]))
+      create_tab(uri, TRUE);
+    else
+      open_uri(wv, uri);
+  }
+
+  g_free(uri);
+
+  return JSValueMakeUndefined(context);
+}
+
+JSValueRef
+cb_js_set_mode(JSContextRef context, JSObjectRef UNUSED(function), JSObjectRef object,
+    size_t argc, const JSValueRef argv[], JSValueRef* UNUSED(exception))
+{
+  WebKitWebView* wv = JSObjectGetPrivate(object);
+
+  /* only the visible tab may change the mode */
+  if(!wv || wv != GET_CURRENT_TAB() || argc < 1)
+    return JSValueMakeUndefined(context);
+
+  char* mode = reference_to_string(context, argv[0]);
+
+  if(!g_strcmp0(mode, "normal"))
+    change_mode(NORMAL);
+  else if(!g_strcmp0(mode, "insert"))
+    change_mode(INSERT);
+
+  g_free(mode);
+
+  return JSValueMakeUndefined(context);
+}
+
+gboolean
+cb_tabbar_expose(GtkWidget* widget, GdkEventExpose* event, gpointer UNUSED(data))
+{
+  GtkAllocation allocation;
+  gtk_widget_get_allocation(widget, &allocation);
+
+  cairo_t* cairo = gdk_cairo_create(gtk_widget_get_window(widget));
+
+  /* draw only the damaged region */
+  gdk_cairo_rectangle(cairo, &(event->area));
+  cairo_clip(cairo);
+
+  gdk_cairo_set_source_color(cairo, &(Jumanji.Style.tabbar_bg));
+  cairo_paint(cairo);
+
+  int number_of_tabs = gtk_notebook_get_n_pages(Jumanji.UI.view);
+  int width          = get_tab_width();
+  int first          = MAX((event->area.x + Jumanji.Tabbar.offset) / width, 0);
+  int last           = MIN((event->area.x + event->area.width + Jumanji.Tabbar.offset) / width, number_of_tabs - 1);
+
+  for(int tc = first; tc <= last; tc++)
+  {
+    GtkWidget*   tab    = GTK_WIDGET(GET_NTH_TAB_WIDGET(tc));
+    PangoLayout* layout = PANGO_LAYOUT(g_object_get_data(G_OBJECT(tab), "layout"));
+    int          x      = tc * width - Jumanji.Tabbar.offset;
+
+    if(tab == Jumanji.Global.focused_tab)
+    {
+      gdk_cairo_set_source_color(cairo, &(Jumanji.Style.tabbar_focus_bg));
+      cairo_rectangle(cairo, x, 0, width, allocation.height);
+      cairo_fill(cairo);
+      gdk_cairo_set_source_color(cairo, &(Jumanji.Style.tabbar_focus_fg));
+    }
+    else
+      gdk_cairo_set_source_color(cairo, &(Jumanji.Style.tabbar_fg));
+
+    /* label */
+    if(layout)
+    {
+      pango_layout_set_width(layout, MAX(width - 9, 0) * PANGO_SCALE);
+      cairo_move_to(cairo, x + 4, 2);
+      pango_cairo_show_layout(cairo, layout);
+    }
+
+    /* separator */
+    gdk_cairo_set_source_color(cairo, &(Jumanji.Style.tabbar_separator));
+    cairo_rectangle(cairo, x + width - 1, 0, 1, allocation.height);
+    cairo_fill(cairo);
+  }
+
+  cairo_destroy(cairo);
+
+  return TRUE;
+}
+
+gboolean
+cb_tabbar_scroll(GtkWidget* UNUSED(widget), GdkEventScroll* event, gpointer UNUSED(data))
+{
+  int width  = get_tab_width();
+  int offset = Jumanji.Tabbar.offset;
+
+  if(event->direction == GDK_SCROLL_UP || event->direction == GDK_SCROLL_LEFT)
+    offset -= width;
+  else
+    offset += width;
+
+  set_tabbar_offset(offset);
+
+  return TRUE;
+}
+
+void
+cb_tabbar_size_allocate(GtkWidget* UNUSED(widget), GtkAllocation* UNUSED(allocation), gpointer UNUSED(data))
+{
+  /* keep the current tab visible when the window is resized */
+  update_tabbar_offset(gtk_notebook_get_current_page(Jumanji.UI.view));
+}
+
+void
+cb_script_changed(GFileMonitor* UNUSED(monitor), GFile* file, GFile* UNUSED(other_file),
+    GFileMonitorEvent event, gpointer data)
+{
+  if(event != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT && event != G_FILE_MONITOR_EVENT_CREATED)
+    return;
+
+  /* read the script without blocking the ui */
+  g_file_load_contents_async(file, NULL, cb_script_loaded, data);
+}
+
+void
+cb_script_loaded(GObject* source, GAsyncResult* result, gpointer data)
+{
+  ScriptList* script  = (ScriptList*) data;
+  char*       content = NULL;
+
+  if(!g_file_load_contents_finish(G_FILE(source), result, &content, NULL, NULL, NULL))
+    return;
+
+  if(!strcmp(content, script->content))
+  {
+    g_free(content);
+    return;
+  }
+
+  g_free(script->content);
+  script->content = content;
+
+  /* a site specific script is compiled on its own, only global scripts
+   * require the shared bundle to be rebuilt */
+  if(script->patterns && *script->patterns)
+  {
+    if(script->source)
+      JSStringRelease(script->source);
+
+    script->source = JSStringCreateWithUTF8CString(script->content);
+    Jumanji.Global.script_generation++;
+  }
+  else
+    update_script_bundle();
+}
+
+gboolean
+cb_update_status(gpointer UNUSED(data))
+{
+  int flags = Jumanji.Update.flags;
+
+  Jumanji.Update.flags  = 0;
+  Jumanji.Update.source = 0;
+  g_timer_start(Jumanji.Update.timer);
+
+  if(!Jumanji.UI.view || gtk_notebook_get_current_page(Jumanji.UI.view) == -1)
+    return FALSE;
+
+  /* a full status update includes the uri and the position */
+  if(flags & UPDATE_STATUS)
+    update_status();
+  else
+  {
+    if(flags & UPDATE_URI)
+      update_uri();
+    if(flags & UPDATE_POSITION)
+      update_position();
+  }
+
+  if(flags & UPDATE_LINK)
+  {
+    if(Jumanji.Update.link)
+      gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.text, Jumanji.Update.link);
+    else if(!(flags & (UPDATE_STATUS | UPDATE_URI)))
+      update_uri();
+  }
+
+  return FALSE;
+}
+
+void
+cb_view_switch_page(GtkNotebook* UNUSED(notebook), gpointer UNUSED(page), guint page_num, gpointer UNUSED(data))
+{
+  WebKitWebView* previous = Jumanji.Scheduler.focused;
+
+  Jumanji.Scheduler.focused = GET_NTH_TAB(page_num);
+
+  /* the previous tab goes to the background, the new one gets its held back requests */
+  if(previous && previous != Jumanji.Scheduler.focused)
+    set_request_priority(previous, SOUP_MESSAGE_PRIORITY_LOW);
+
+  set_request_priority(Jumanji.Scheduler.focused, SOUP_MESSAGE_PRIORITY_HIGH);
+  run_pending_requests(Jumanji.Scheduler.focused);
+}
+
 GtkWidget*
 cb_wv_block_plugin(WebKitWebView* UNUSED(wv), gchar* mime_type, gchar* uri,
     GHashTable* UNUSED(param), gpointer UNUSED(data))
@@ -4450,8 +8423,11 @@ cb_wv_block_plugin(WebKitWebView* UNUSED(wv), gchar* mime_type, gchar* uri,
 }
 
 gboolean
-cb_wv_button_release_event(GtkWidget* UNUSED(widget), GdkEvent* event, gpointer UNUSED(data))
+cb_wv_button_release_event(GtkWidget* widget, GdkEvent* event, gpointer UNUSED(data))
 {
+  /* a click can move the selection, the search ordinal is counted again */
+  g_object_set_data(G_OBJECT(widget), "search_index", NULL);
+
   for(unsigned int i = 0; i < LENGTH(mouse); i++)
   {
     if(
@@ -4469,21 +8445,13 @@ cb_wv_button_release_event(GtkWidget* UNUSED(widget), GdkEvent* event, gpointer
   return FALSE;
 }
 
-gboolean
-cb_wv_console(WebKitWebView* UNUSED(wv), char* message, int UNUSED(line),
-    char* UNUSED(source), gpointer UNUSED(data))
-{
-  if(!strcmp(message, "hintmode_off") || !strcmp(message, "insertmode_off"))
-    change_mode(NORMAL);
-  else if(!strcmp(message, "insertmode_on"))
-    change_mode(INSERT);
-
-  return TRUE;
-}
-
 GtkWidget*
 cb_wv_create_web_view(WebKitWebView* wv, WebKitWebFrame* UNUSED(frame), gpointer UNUSED(data))
 {
+  /* a page which has not been opened yet must not open windows */
+  if(wv == Jumanji.Prerender.view)
+    return NULL;
+
   char* uri = (char*) webkit_web_view_get_uri(wv);
   GtkWidget* tab = create_tab(uri, TRUE);
 
@@ -4515,6 +8483,8 @@ cb_wv_download_request(WebKitWebView* UNUSED(wv), WebKitDownload* download, gpoi
   char* file      = g_build_filename(download_path, filename ? filename : uri, NULL);
   char* command   = g_strdup_printf(download_command, uri, file);
 
+  /* the download command reads the cookie file */
+  flush_cookies();
   g_spawn_command_line_async(command, NULL);
 
   g_free(file);
@@ -4541,14 +8511,11 @@ cb_wv_mimetype_policy_decision(WebKitWebView* wv, WebKitWebFrame* UNUSED(frame),
 gboolean
 cb_wv_hover_link(WebKitWebView* UNUSED(wv), char* UNUSED(title), char* link, gpointer UNUSED(data))
 {
-  if(link)
-  {
-    link = g_strconcat("Link: ", link, NULL);
-    gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.text, link);
-    g_free(link);
-  }
-  else
-    gtk_label_set_text((GtkLabel*) Jumanji.Statusbar.text, webkit_web_view_get_uri(GET_CURRENT_TAB()));
+  g_free(Jumanji.Update.link);
+  Jumanji.Update.link = link ? g_strconcat("Link: ", link, NULL) : NULL;
+
+  prefetch_uri(link);
+  schedule_update(UPDATE_LINK);
 
   return TRUE;
 }
@@ -4602,8 +8569,15 @@ cb_wv_nav_policy_decision(WebKitWebView* UNUSED(wv), WebKitWebFrame* UNUSED(fram
 gboolean
 cb_wv_notify_progress(WebKitWebView* wv, GParamSpec* UNUSED(pspec), gpointer UNUSED(data))
 {
+  /* the text snapshot is outdated while the page is loading */
+  g_object_set_data(G_OBJECT(wv), "text_snapshot", NULL);
+
+  /* the label shows the loading state of untitled pages */
+  mark_tab_dirty(gtk_widget_get_parent(GTK_WIDGET(wv)));
+  schedule_update(UPDATE_STATUS);
+
   if(wv == GET_CURRENT_TAB() && gtk_notebook_get_current_page(Jumanji.UI.view) != -1)
-    update_uri();
+    schedule_update(UPDATE_URI);
 
   return TRUE;
 }
@@ -4611,20 +8585,68 @@ cb_wv_notify_progress(WebKitWebView* wv, GParamSpec* UNUSED(pspec), gpointer UNU
 gboolean
 cb_wv_notify_title(WebKitWebView* wv, GParamSpec* UNUSED(pspec), gpointer UNUSED(data))
 {
-  const char* title = webkit_web_view_get_title(wv);
-  if(title)
+  /* a title which becomes NULL changes the label too */
+  mark_tab_dirty(gtk_widget_get_parent(GTK_WIDGET(wv)));
+  schedule_update(UPDATE_STATUS);
+
+  return TRUE;
+}
+
+void
+cb_wv_load_committed(WebKitWebView* wv, WebKitWebFrame* frame, gpointer UNUSED(data))
+{
+  if(frame != webkit_web_view_get_main_frame(wv))
+    return;
+
+  /* search matches, text and blocked requests belong to the old document,
+   * a document without a new window object (e.g. an image) resets them too */
+  g_object_set_data(G_OBJECT(wv), "search_query", NULL);
+  g_object_set_data(G_OBJECT(wv), "search_count", NULL);
+  g_object_set_data(G_OBJECT(wv), "search_index", NULL);
+  g_object_set_data(G_OBJECT(wv), "text_snapshot", NULL);
+  g_object_set_data(G_OBJECT(wv), "blocked_requests", NULL);
+
+  /* a new document replaces the label of the old one */
+  mark_tab_dirty(gtk_widget_get_parent(GTK_WIDGET(wv)));
+  schedule_update(UPDATE_STATUS);
+}
+
+void
+cb_wv_resource_request_starting(WebKitWebView* wv, WebKitWebFrame* frame, WebKitWebResource* resource,
+    WebKitNetworkRequest* request, WebKitNetworkResponse* UNUSED(response), gpointer UNUSED(data))
+{
+  WebKitWebDataSource* data_source   = webkit_web_frame_get_provisional_data_source(frame);
+  gboolean             main_resource = data_source && resource == webkit_web_data_source_get_main_resource(data_source);
+
+  /* a new page starts a new section of the load timeline */
+  if(main_resource && frame == webkit_web_view_get_main_frame(wv))
+    get_load_timeline(wv)->page_start = g_get_real_time();
+
+  /* never block the document of a frame itself */
+  const char* uri = webkit_network_request_get_uri(request);
+  if(!content_blocker || main_resource || !uri || !is_blocked(uri))
   {
-    gtk_window_set_title(GTK_WINDOW(Jumanji.UI.window), title);
-    update_status();
+    /* remember the tab and the page of the request for the scheduler, the
+     * page of a new document is the document itself */
+    const char* document = (main_resource && frame == webkit_web_view_get_main_frame(wv)) ? uri :
+      webkit_web_frame_get_uri(webkit_web_view_get_main_frame(wv));
+    tag_request(wv, uri, document);
+    return;
   }
 
-  return TRUE;
+  webkit_network_request_set_uri(request, "about:blank");
+
+  int blocked = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(wv), "blocked_requests"));
+  g_object_set_data(G_OBJECT(wv), "blocked_requests", GINT_TO_POINTER(blocked + 1));
+
+  if(wv == GET_CURRENT_TAB())
+    schedule_update(UPDATE_URI);
 }
 
 gboolean
 cb_wv_scrolled(GtkAdjustment* UNUSED(adjustment), gpointer UNUSED(data))
 {
-  update_position();
+  schedule_update(UPDATE_POSITION);
   return TRUE;
 }
 
@@ -4662,23 +8684,19 @@ cb_wv_window_policy_decision(WebKitWebView* UNUSED(wv), WebKitWebFrame* UNUSED(f
 }
 
 gboolean
-cb_wv_window_object_cleared(WebKitWebView* UNUSED(wv), WebKitWebFrame* UNUSED(frame), gpointer context,
+cb_wv_window_object_cleared(WebKitWebView* wv, WebKitWebFrame* frame, gpointer context,
     gpointer UNUSED(window_object), gpointer UNUSED(data))
 {
-  /* load all added scripts */
+  /* function handles of the old document are gone */
+  if(frame == webkit_web_view_get_main_frame(wv))
+    clear_script_functions(wv, (JSContextRef) context);
 
-  JSStringRef script;
-  JSValueRef exc;
-  GString *buffer = g_string_new(NULL);
+  /* the bridge has to exist before any user script runs */
+  inject_bridge(wv, (JSContextRef) context);
 
-  for (ScriptList *l = Jumanji.Global.scripts; l; l=l->next) {
-    g_string_append(buffer, l->content);
-  }
-  script = JSStringCreateWithUTF8CString(buffer->str);
-  JSEvaluateScript((JSContextRef)context, script, JSContextGetGlobalObject((JSContextRef)context), NULL, 0, &exc);
-  JSStringRelease(script);
-  g_string_free(buffer, true);
-  load_all_scripts();
+  /* load all added scripts into the new document of this frame */
+  g_object_set_data(G_OBJECT(frame), "script_generation", GINT_TO_POINTER(0));
+  inject_scripts(frame);
   return TRUE;
 }
 